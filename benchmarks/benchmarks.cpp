@@ -0,0 +1,493 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "buffering.h"
+#include "corpus.h"
+#include "rlp_prefix_table.h"
+#include "lib/crypto.h"
+#include "lib/parser.h"
+#include "utils/base58.h"
+#include "utils/uint256.h"
+#include "utils/utils.h"
+#include "view_internal.h"
+
+// defined in crypto.c, not exported by crypto.h
+extern "C" void keccak(uint8_t *out, size_t out_len, uint8_t *in, size_t in_len);
+
+namespace {
+
+// Fixed corpus: one tx per type with 64 bytes of DATA (256 bytes of JSON for the
+// JSON types) and 4 extraTo recipients. Results can be compared between releases
+// as long as these parameters do not change
+constexpr uint16_t CORPUS_DATA_LEN = 256;
+constexpr uint16_t CORPUS_HEX_DATA_LEN = 64;
+constexpr uint16_t CORPUS_EXTRATO_COUNT = 4;
+constexpr uint32_t CORPUS_SEED = 1;
+
+std::vector<uint8_t> corpusTx(uint8_t txType) {
+    corpus_params_t params{};
+    params.txType = txType;
+    params.extraToCount = CORPUS_EXTRATO_COUNT;
+    params.seed = CORPUS_SEED;
+    switch (txType) {
+        case MANTX_TXTYPE_AUTHORIZED:
+        case MANTX_TXTYPE_CANCEL_AUTH:
+        case MANTX_TXTYPE_CREATE_CURR:
+            params.dataLen = CORPUS_DATA_LEN;
+            break;
+        default:
+            params.dataLen = CORPUS_HEX_DATA_LEN;
+            break;
+    }
+
+    std::vector<uint8_t> tx(CORPUS_MAX_TX_LEN);
+    uint32_t written = 0;
+    if (corpus_buildTx(&params, tx.data(), (uint32_t) tx.size(), &written) != RLP_NO_ERROR) {
+        return {};
+    }
+    tx.resize(written);
+    return tx;
+}
+
+uint256_t corpusUInt256(uint64_t seed) {
+    uint8_t bytes[32];
+    for (uint8_t i = 0; i < sizeof(bytes); i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        bytes[i] = (uint8_t) (seed >> 56);
+    }
+    uint256_t value;
+    readu256BE(bytes, &value);
+    return value;
+}
+
+std::vector<uint8_t> corpusBytes(size_t len) {
+    std::vector<uint8_t> bytes(len);
+    for (size_t i = 0; i < len; i++) {
+        bytes[i] = (uint8_t) (i * 131 + 7);
+    }
+    return bytes;
+}
+
+bool loadTx(benchmark::State &state, const std::vector<uint8_t> &tx) {
+    if (tx.empty()) {
+        state.SkipWithError("the corpus tx could not be encoded");
+        return false;
+    }
+    return true;
+}
+
+////////////////// RLP / parser, once per tx type
+
+void BM_rlp_parseStream(benchmark::State &state, uint8_t txType) {
+    const auto tx = corpusTx(txType);
+    if (!loadTx(state, tx)) return;
+
+    rlp_field_t fields[MANTX_ROOTFIELD_COUNT];
+    uint16_t fieldCount;
+    for (auto _ : state) {
+        // the root list, then its fields
+        int8_t err = rlp_parseStream(tx.data(), 0, tx.size(), fields, 1, &fieldCount);
+        const uint16_t rootOffset = fields[0].fieldOffset + fields[0].valueOffset;
+        err |= rlp_parseStream(tx.data(), rootOffset, rootOffset + fields[0].valueLen,
+                               fields, MANTX_ROOTFIELD_COUNT, &fieldCount);
+        benchmark::DoNotOptimize(err);
+        benchmark::DoNotOptimize(fields);
+    }
+    state.SetBytesProcessed(state.iterations() * tx.size());
+}
+
+void BM_parser_parse(benchmark::State &state, uint8_t txType) {
+    const auto tx = corpusTx(txType);
+    if (!loadTx(state, tx)) return;
+
+    parser_context_t ctx;
+    static parser_tx_t tx_obj;
+    for (auto _ : state) {
+        parser_error_t err = parser_parse(&ctx, tx.data(), tx.size(), &tx_obj);
+        benchmark::DoNotOptimize(err);
+    }
+    state.SetBytesProcessed(state.iterations() * tx.size());
+}
+
+void BM_parser_validate(benchmark::State &state, uint8_t txType) {
+    const auto tx = corpusTx(txType);
+    if (!loadTx(state, tx)) return;
+
+    parser_context_t ctx;
+    static parser_tx_t tx_obj;
+    if (parser_parse(&ctx, tx.data(), tx.size(), &tx_obj) != parser_ok) {
+        state.SkipWithError("the corpus tx could not be parsed");
+        return;
+    }
+    for (auto _ : state) {
+        parser_error_t err = parser_validate(&ctx);
+        benchmark::DoNotOptimize(err);
+    }
+}
+
+// Renders every page of every item, as the user would while reviewing the tx
+void BM_parser_getItem(benchmark::State &state, uint8_t txType) {
+    const auto tx = corpusTx(txType);
+    if (!loadTx(state, tx)) return;
+
+    parser_context_t ctx;
+    static parser_tx_t tx_obj;
+    if (parser_parse(&ctx, tx.data(), tx.size(), &tx_obj) != parser_ok) {
+        state.SkipWithError("the corpus tx could not be parsed");
+        return;
+    }
+
+    char key[MAX_CHARS_PER_KEY_LINE];
+    char value[MAX_CHARS_PER_VALUE1_LINE];
+    int64_t pages = 0;
+    for (auto _ : state) {
+        const uint16_t numItems = parser_getNumItems(&ctx);
+        for (uint16_t i = 0; i < numItems; i++) {
+            uint8_t pageCount = 1;
+            for (uint8_t page = 0; page < pageCount; page++) {
+                parser_getItem(&ctx, i, key, sizeof(key), value, sizeof(value), page, &pageCount);
+                benchmark::DoNotOptimize(value);
+                pages++;
+            }
+        }
+    }
+    state.counters["pages"] = benchmark::Counter((double) pages, benchmark::Counter::kIsRate);
+}
+
+////////////////// uint256
+
+void BM_tostring256(benchmark::State &state) {
+    uint256_t value = corpusUInt256(1);
+    const uint32_t base = (uint32_t) state.range(0);
+    char out[100];
+    for (auto _ : state) {
+        bool ok = tostring256(&value, base, out, sizeof(out));
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(BM_tostring256)->Arg(10)->Arg(16);
+
+void BM_divmod256(benchmark::State &state) {
+    uint256_t l = corpusUInt256(1);
+    uint256_t r = corpusUInt256(2);
+    // a divisor of range(0) bits
+    shiftr256(&r, 256 - (uint32_t) state.range(0), &r);
+    uint256_t div;
+    uint256_t mod;
+    for (auto _ : state) {
+        divmod256(&l, &r, &div, &mod);
+        benchmark::DoNotOptimize(div);
+        benchmark::DoNotOptimize(mod);
+    }
+}
+BENCHMARK(BM_divmod256)->Arg(32)->Arg(128)->Arg(250);
+
+////////////////// addresses
+
+void BM_encode_base58(benchmark::State &state) {
+    const auto in = corpusBytes(state.range(0));
+    unsigned char out[128];
+    for (auto _ : state) {
+        size_t outLen = sizeof(out);
+        int err = encode_base58(in.data(), in.size(), out, &outLen);
+        benchmark::DoNotOptimize(err);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_encode_base58)->Arg(20)->Arg(32)->Arg(64);
+
+// Fixed size path used for addresses, to compare with BM_encode_base58/20
+void BM_encode_base58_20(benchmark::State &state) {
+    const auto in = corpusBytes(20);
+    unsigned char out[128];
+    for (auto _ : state) {
+        size_t outLen = sizeof(out);
+        int err = encode_base58_20(in.data(), out, &outLen);
+        benchmark::DoNotOptimize(err);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_encode_base58_20);
+
+void BM_decode_base58(benchmark::State &state) {
+    const auto in = corpusBytes(state.range(0));
+    unsigned char encoded[128];
+    size_t encodedLen = sizeof(encoded);
+    encode_base58(in.data(), in.size(), encoded, &encodedLen);
+
+    unsigned char out[128];
+    for (auto _ : state) {
+        size_t outLen = sizeof(out);
+        int err = decode_base58((const char *) encoded, encodedLen, out, &outLen);
+        benchmark::DoNotOptimize(err);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * encodedLen);
+}
+BENCHMARK(BM_decode_base58)->Arg(20)->Arg(32)->Arg(64);
+
+void BM_manAddressFromEthAddr(benchmark::State &state) {
+    auto ethAddress = corpusBytes(20);
+    char out[64];
+    for (auto _ : state) {
+        uint8_t len = manAddressFromEthAddr(out, ethAddress.data());
+        benchmark::DoNotOptimize(len);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(BM_manAddressFromEthAddr);
+
+////////////////// hashing, checksums
+
+void BM_keccak(benchmark::State &state) {
+    auto in = corpusBytes(state.range(0));
+    uint8_t out[32];
+    for (auto _ : state) {
+        keccak(out, sizeof(out), in.data(), in.size());
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_keccak)->Arg(64)->Arg(1024)->Arg(CORPUS_MAX_TX_LEN);
+
+void BM_crc8(benchmark::State &state) {
+    const auto in = corpusBytes(state.range(0));
+    for (auto _ : state) {
+        uint8_t crc = crc8(in.data(), in.size());
+        benchmark::DoNotOptimize(crc);
+    }
+    state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_crc8)->Arg(32)->Arg(1024);
+
+////////////////// display
+
+void BM_printTime(benchmark::State &state) {
+    char out[MAX_CHARS_PER_VALUE1_LINE];
+    uint64_t t = 1546300800;
+    for (auto _ : state) {
+        printTime(out, sizeof(out), t);
+        benchmark::DoNotOptimize(out);
+        t += 86399;
+    }
+}
+BENCHMARK(BM_printTime);
+
+////////////////// APDU buffering
+
+// Appends a whole tx in chunks of range(0) bytes, as they arrive from the host
+void BM_buffering_append(benchmark::State &state) {
+    static uint8_t ramBuffer[384];
+    static uint8_t flashBuffer[CORPUS_MAX_TX_LEN];
+    buffering_init(ramBuffer, sizeof(ramBuffer), flashBuffer, sizeof(flashBuffer));
+
+    auto tx = corpusBytes(8192);
+    const int chunkLen = (int) state.range(0);
+    for (auto _ : state) {
+        buffering_reset();
+        for (size_t offset = 0; offset < tx.size(); offset += chunkLen) {
+            // the last chunk only holds what is left of the tx
+            const int len = (int) std::min<size_t>(chunkLen, tx.size() - offset);
+            int appended = buffering_append(tx.data() + offset, len);
+            benchmark::DoNotOptimize(appended);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * tx.size());
+}
+BENCHMARK(BM_buffering_append)->Arg(64)->Arg(250);
+
+////////////////// RLP prefix classification: the range comparisons of rlp.c against a prefix table
+
+typedef int16_t (*rlp_headerDecoder_t)(const uint8_t *, const uint8_t *, uint8_t *, uint16_t *, uint16_t *);
+
+// Decodes every header of the tx in order, stepping into lists and over strings. Returns the header count
+int64_t decodeHeaders(const std::vector<uint8_t> &tx, rlp_headerDecoder_t decode) {
+    const uint8_t *p = tx.data();
+    const uint8_t *end = p + tx.size();
+    int64_t count = 0;
+    while (p < end) {
+        uint8_t kind;
+        uint16_t len;
+        uint16_t valueOffset;
+        const int16_t itemLen = decode(p, end, &kind, &len, &valueOffset);
+        if (itemLen < 0) {
+            return -1;
+        }
+        p += kind == RLP_KIND_LIST ? valueOffset : itemLen;
+        count++;
+    }
+    return count;
+}
+
+// both decoders have to agree on every header before they are timed
+bool sameHeaders(const std::vector<uint8_t> &tx) {
+    const uint8_t *end = tx.data() + tx.size();
+    for (const uint8_t *p = tx.data(); p < end; p++) {
+        uint8_t kind[2];
+        uint16_t len[2];
+        uint16_t valueOffset[2];
+        const int16_t a = rlp_decodeHeader(p, end, &kind[0], &len[0], &valueOffset[0]);
+        const int16_t b = rlp_decodeHeaderTable(p, end, &kind[1], &len[1], &valueOffset[1]);
+        if (a != b || (a >= 0 && (kind[0] != kind[1] || len[0] != len[1] || valueOffset[0] != valueOffset[1]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BM_rlp_decodeHeader(benchmark::State &state, rlp_headerDecoder_t decode,
+                         const std::vector<std::vector<uint8_t>> *txs) {
+    if (txs->empty()) {
+        state.SkipWithError("the corpus is empty");
+        return;
+    }
+    for (const auto &tx : *txs) {
+        if (!sameHeaders(tx)) {
+            state.SkipWithError("the range comparisons and the prefix table disagree");
+            return;
+        }
+    }
+
+    int64_t headers = 0;
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        for (const auto &tx : *txs) {
+            const int64_t count = decodeHeaders(tx, decode);
+            benchmark::DoNotOptimize(count);
+            headers += count;
+            bytes += tx.size();
+        }
+    }
+    state.SetItemsProcessed(headers);
+    state.SetBytesProcessed(bytes);
+}
+
+////////////////// corpus files written by corpus_gen
+
+std::vector<std::vector<uint8_t>> loadCorpusFile(const char *path) {
+    std::vector<std::vector<uint8_t>> txs;
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr || corpus_readHeader(f) != CORPUS_OK) {
+        fprintf(stderr, "%s is not a corpus file\n", path);
+        exit(1);
+    }
+
+    static uint8_t tx[CORPUS_MAX_TX_LEN];
+    uint16_t txLen;
+    int err;
+    while ((err = corpus_readTx(f, tx, sizeof(tx), &txLen)) == CORPUS_OK) {
+        txs.emplace_back(tx, tx + txLen);
+    }
+    fclose(f);
+    if (err != CORPUS_END) {
+        fprintf(stderr, "%s is truncated or corrupt\n", path);
+        exit(1);
+    }
+    return txs;
+}
+
+// Parses and validates the txs of the corpus file in turn, as a screening service would
+void BM_corpus_parse(benchmark::State &state, const std::vector<std::vector<uint8_t>> *txs) {
+    if (txs->empty()) {
+        state.SkipWithError("the corpus file is empty");
+        return;
+    }
+
+    parser_context_t ctx;
+    static parser_tx_t tx_obj;
+    size_t i = 0;
+    int64_t bytes = 0;
+    int64_t invalid = 0;
+    for (auto _ : state) {
+        const auto &tx = (*txs)[i];
+        parser_error_t err = parser_parse(&ctx, tx.data(), tx.size(), &tx_obj);
+        if (err == parser_ok) {
+            err = parser_validate(&ctx);
+        }
+        invalid += err != parser_ok;
+        bytes += tx.size();
+        if (++i == txs->size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+    state.counters["invalid"] = (double) invalid;
+}
+
+void registerDecodeHeaderBenchmarks(const std::string &name, const std::vector<std::vector<uint8_t>> *txs) {
+    benchmark::RegisterBenchmark((name + "/branches").c_str(), BM_rlp_decodeHeader, rlp_decodeHeader, txs);
+    benchmark::RegisterBenchmark((name + "/table").c_str(), BM_rlp_decodeHeader, rlp_decodeHeaderTable, txs);
+}
+
+void registerTxTypeBenchmarks() {
+    for (uint8_t txType : corpus_txTypes) {
+        const std::string name = corpus_txTypeName(txType);
+        benchmark::RegisterBenchmark(("BM_rlp_parseStream/" + name).c_str(), BM_rlp_parseStream, txType);
+        benchmark::RegisterBenchmark(("BM_parser_parse/" + name).c_str(), BM_parser_parse, txType);
+        benchmark::RegisterBenchmark(("BM_parser_validate/" + name).c_str(), BM_parser_validate, txType);
+        benchmark::RegisterBenchmark(("BM_parser_getItem/" + name).c_str(), BM_parser_getItem, txType);
+    }
+
+    static std::vector<std::vector<uint8_t>> fixedTxs;
+    for (uint8_t txType : corpus_txTypes) {
+        fixedTxs.push_back(corpusTx(txType));
+    }
+    registerDecodeHeaderBenchmarks("BM_rlp_decodeHeader", &fixedTxs);
+}
+
+}
+
+// --corpus=FILE adds a benchmark that replays a corpus written by corpus_gen
+int main(int argc, char **argv) {
+    static const char corpusArg[] = "--corpus=";
+    static std::vector<std::vector<uint8_t>> corpusTxs;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], corpusArg, sizeof(corpusArg) - 1) == 0) {
+            corpusTxs = loadCorpusFile(argv[i] + sizeof(corpusArg) - 1);
+            benchmark::RegisterBenchmark("BM_corpus_parse", BM_corpus_parse, &corpusTxs);
+            registerDecodeHeaderBenchmarks("BM_corpus_decodeHeader", &corpusTxs);
+            benchmark::AddCustomContext("corpus", argv[i] + sizeof(corpusArg) - 1);
+            // hide it from the benchmark flags
+            for (int j = i; j < argc - 1; j++) {
+                argv[j] = argv[j + 1];
+            }
+            argc--;
+            i--;
+        }
+    }
+
+    registerTxTypeBenchmarks();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
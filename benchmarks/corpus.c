@@ -0,0 +1,228 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "corpus.h"
+#include "lib/crypto.h"
+#include "lib/mantx_encode.h"
+#include "lib/parser_txdef.h"
+
+// "MAN." + base58 of 20 bytes + crc char + terminator
+#define CORPUS_ADDRESS_SIZE 40
+
+const uint8_t corpus_txTypes[CORPUS_TXTYPE_COUNT] = {
+        MANTX_TXTYPE_NORMAL,
+        MANTX_TXTYPE_SCHEDULED,
+        MANTX_TXTYPE_REVERT,
+        MANTX_TXTYPE_AUTHORIZED,
+        MANTX_TXTYPE_CANCEL_AUTH,
+        MANTX_TXTYPE_CREATE_CURR,
+};
+
+const char *corpus_txTypeName(uint8_t txType) {
+    switch (txType) {
+        case MANTX_TXTYPE_NORMAL:
+            return "Normal";
+        case MANTX_TXTYPE_SCHEDULED:
+            return "Scheduled";
+        case MANTX_TXTYPE_REVERT:
+            return "Revert";
+        case MANTX_TXTYPE_AUTHORIZED:
+            return "Authorize";
+        case MANTX_TXTYPE_CANCEL_AUTH:
+            return "CancelAuth";
+        case MANTX_TXTYPE_CREATE_CURR:
+            return "CreateCurr";
+        default:
+            return "Unknown";
+    }
+}
+
+// xorshift64*, so that a seed gives the same tx on every platform
+static uint64_t corpus_next(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static void corpus_address(uint64_t *state, char *out) {
+    uint8_t ethAddress[20];
+    for (uint8_t i = 0; i < sizeof(ethAddress); i++) {
+        ethAddress[i] = (uint8_t) corpus_next(state);
+    }
+    manAddressFromEthAddr(out, ethAddress);
+}
+
+// an amount between 0.001 and ~18 MAN, in wei
+static void corpus_amount(uint64_t *state, uint256_t *amount) {
+    clear256(amount);
+    LOWER(LOWER_P(amount)) = 1000000000000000ULL * (1 + corpus_next(state) % 18000);
+}
+
+// Appends a formatted string if it fits. Returns the new length or 0 if it does not fit
+static uint16_t corpus_append(char *out, uint16_t len, uint16_t maxLen, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    const int n = vsnprintf(out + len, maxLen - len + 1, fmt, args);
+    va_end(args);
+    if (n < 0 || len + n > maxLen)
+        return 0;
+    return len + n;
+}
+
+// Authorize / Cancel Auth: entrust list with as many entries as fit in maxLen
+static uint16_t corpus_entrustJson(uint64_t *state, char *out, uint16_t maxLen) {
+    static const char tail[] = "],\"Flag\":1}";
+    char address[CORPUS_ADDRESS_SIZE];
+    uint16_t len = corpus_append(out, 0, maxLen, "{\"EntrustList\":[");
+    if (len == 0)
+        return 0;
+
+    for (uint16_t i = 0;; i++) {
+        corpus_address(state, address);
+        const uint64_t start = 1000000 + corpus_next(state) % 1000000;
+        const uint16_t n = corpus_append(out, len, maxLen,
+                                         "%s{\"EntrustAddres\":\"%s\",\"IsEntrustGas\":true,"
+                                         "\"IsEntrustSign\":false,\"StartHeight\":%llu,\"EndHeight\":%llu}",
+                                         i == 0 ? "" : ",", address,
+                                         (unsigned long long) start, (unsigned long long) (start + 100000));
+        // keep room to close the list
+        if (n == 0 || n + sizeof(tail) - 1 > maxLen)
+            break;
+        len = n;
+    }
+
+    return corpus_append(out, len, maxLen, "%s", tail);
+}
+
+// Create Currency: currency definition padded with a description to reach maxLen
+static uint16_t corpus_currencyJson(uint64_t *state, char *out, uint16_t maxLen) {
+    char owner[CORPUS_ADDRESS_SIZE];
+    corpus_address(state, owner);
+    const uint16_t len = corpus_append(out, 0, maxLen,
+                                       "{\"CoinName\":\"BTM%u\",\"PackNum\":%u,\"CoinUnit\":\"%s\","
+                                       "\"TxGas\":21000,\"Desc\":\"",
+                                       (unsigned) (corpus_next(state) % 1000),
+                                       (unsigned) (1 + corpus_next(state) % 32), owner);
+    if (len == 0 || len + 2 > maxLen)
+        return corpus_append(out, 0, maxLen, "{}");
+
+    uint16_t descLen = maxLen - len - 2;
+    for (uint16_t i = 0; i < descLen; i++) {
+        out[len + i] = (char) ('a' + corpus_next(state) % 26);
+    }
+    return corpus_append(out, len + descLen, maxLen, "\"}");
+}
+
+int8_t corpus_buildTx(const corpus_params_t *params, uint8_t *out, uint32_t outLen, uint32_t *written) {
+    static uint8_t data[CORPUS_MAX_DATA_LEN + 1];
+    static char addresses[CORPUS_MAX_EXTRATO + 1][CORPUS_ADDRESS_SIZE];
+    static mantx_extrato_t extraTo[CORPUS_MAX_EXTRATO];
+
+    *written = 0;
+    if (params->dataLen > CORPUS_MAX_DATA_LEN || params->extraToCount > CORPUS_MAX_EXTRATO)
+        return RLP_ERROR_BUFFER_TOO_SMALL;
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ ((uint64_t) params->seed << 8) ^ params->txType;
+
+    mantx_t tx;
+    memset(&tx, 0, sizeof(tx));
+    tx.nonce = corpus_next(&state) % 100000;
+    LOWER(LOWER(tx.gasPrice)) = 18000000000ULL;
+    LOWER(LOWER(tx.gasLimit)) = 21000 + corpus_next(&state) % 200000;
+    corpus_address(&state, addresses[0]);
+    tx.to = addresses[0];
+    tx.toLen = (uint16_t) strlen(addresses[0]);
+    corpus_amount(&state, &tx.value);
+    tx.v = 3;
+    tx.commitTime = 1546300800 + corpus_next(&state) % 100000000;
+    tx.txType = params->txType;
+    tx.lockHeight = corpus_next(&state) % 10000000;
+
+    switch (params->txType) {
+        case MANTX_TXTYPE_AUTHORIZED:
+        case MANTX_TXTYPE_CANCEL_AUTH:
+            tx.dataLen = corpus_entrustJson(&state, (char *) data, params->dataLen);
+            tx.isEntrustTx = 1;
+            break;
+        case MANTX_TXTYPE_CREATE_CURR:
+            tx.dataLen = corpus_currencyJson(&state, (char *) data, params->dataLen);
+            break;
+        default:
+            for (uint16_t i = 0; i < params->dataLen; i++) {
+                data[i] = (uint8_t) corpus_next(&state);
+            }
+            tx.dataLen = params->dataLen;
+            break;
+    }
+    tx.data = data;
+
+    for (uint16_t i = 0; i < params->extraToCount; i++) {
+        corpus_address(&state, addresses[i + 1]);
+        extraTo[i].to = addresses[i + 1];
+        extraTo[i].toLen = (uint16_t) strlen(addresses[i + 1]);
+        corpus_amount(&state, &extraTo[i].amount);
+        extraTo[i].payload = NULL;
+        extraTo[i].payloadLen = 0;
+    }
+    tx.extraTo = extraTo;
+    tx.extraToCount = params->extraToCount;
+
+    return mantx_encode(&tx, out, outLen, written);
+}
+
+int corpus_writeHeader(FILE *f) {
+    if (fwrite(CORPUS_FILE_MAGIC, 1, CORPUS_FILE_MAGIC_LEN, f) != CORPUS_FILE_MAGIC_LEN)
+        return CORPUS_ERROR_IO;
+    return CORPUS_OK;
+}
+
+int corpus_writeTx(FILE *f, const uint8_t *tx, uint16_t txLen) {
+    const uint8_t len[2] = {(uint8_t) txLen, (uint8_t) (txLen >> 8)};
+    if (fwrite(len, 1, sizeof(len), f) != sizeof(len) || fwrite(tx, 1, txLen, f) != txLen)
+        return CORPUS_ERROR_IO;
+    return CORPUS_OK;
+}
+
+int corpus_readHeader(FILE *f) {
+    char magic[CORPUS_FILE_MAGIC_LEN];
+    if (fread(magic, 1, sizeof(magic), f) != sizeof(magic))
+        return ferror(f) ? CORPUS_ERROR_IO : CORPUS_ERROR_FORMAT;
+    if (memcmp(magic, CORPUS_FILE_MAGIC, CORPUS_FILE_MAGIC_LEN) != 0)
+        return CORPUS_ERROR_FORMAT;
+    return CORPUS_OK;
+}
+
+int corpus_readTx(FILE *f, uint8_t *tx, uint16_t maxLen, uint16_t *txLen) {
+    uint8_t len[2];
+    const size_t n = fread(len, 1, sizeof(len), f);
+    if (n == 0 && feof(f))
+        return CORPUS_END;
+    if (n != sizeof(len))
+        return ferror(f) ? CORPUS_ERROR_IO : CORPUS_ERROR_FORMAT;
+
+    *txLen = (uint16_t) (len[0] | (len[1] << 8));
+    if (*txLen > maxLen)
+        return CORPUS_ERROR_FORMAT;
+    if (fread(tx, 1, *txLen, f) != *txLen)
+        return ferror(f) ? CORPUS_ERROR_IO : CORPUS_ERROR_FORMAT;
+    return CORPUS_OK;
+}
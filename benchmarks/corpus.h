@@ -0,0 +1,68 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Largest tx the app can receive (FLASH_BUFFER_SIZE on Nano X)
+#define CORPUS_MAX_TX_LEN       16384
+#define CORPUS_MAX_DATA_LEN     CORPUS_MAX_TX_LEN
+#define CORPUS_MAX_EXTRATO      512
+
+// Every tx type the parser accepts
+#define CORPUS_TXTYPE_COUNT     6
+extern const uint8_t corpus_txTypes[CORPUS_TXTYPE_COUNT];
+
+typedef struct {
+    uint8_t txType;
+    uint16_t dataLen;           // DATA size. JSON payloads get as many entries as fit
+    uint16_t extraToCount;
+    uint32_t seed;              // the same params always give the same tx
+} corpus_params_t;
+
+// short name of a tx type, used to label results
+const char *corpus_txTypeName(uint8_t txType);
+
+// Encodes the tx described by params. Returns RLP_NO_ERROR or an RLP_ERROR_* code
+int8_t corpus_buildTx(const corpus_params_t *params, uint8_t *out, uint32_t outLen, uint32_t *written);
+
+//// Corpus files: the 4 byte magic, then every tx as a 2 byte little endian length and its bytes
+#define CORPUS_FILE_MAGIC       "MTX1"
+#define CORPUS_FILE_MAGIC_LEN   4
+
+#define CORPUS_OK               0
+#define CORPUS_END              1
+#define CORPUS_ERROR_IO         (-1)
+#define CORPUS_ERROR_FORMAT     (-2)
+
+int corpus_writeHeader(FILE *f);
+
+int corpus_writeTx(FILE *f, const uint8_t *tx, uint16_t txLen);
+
+int corpus_readHeader(FILE *f);
+
+// reads the next tx. Returns CORPUS_END after the last one
+int corpus_readTx(FILE *f, uint8_t *tx, uint16_t maxLen, uint16_t *txLen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,238 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// Writes a corpus of synthetic Matrix txs for benchmarks and fuzzing
+//
+// corpus_gen -o FILE [-n COUNT] [-s SEED] [-d MAX_DATA_LEN] [-e MAX_EXTRATO] [-t TYPE,TYPE,...]
+//
+// Without -t, tx types follow a mainnet-like mix: mostly Normal transfers with short DATA
+// and no extraTo recipients. Sizes are skewed towards small values and every tx fits in
+// CORPUS_MAX_TX_LEN bytes. Every tx is checked with the parser before it is written.
+// The same arguments always give the same file
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "corpus.h"
+#include "lib/parser.h"
+#include "lib/parser_txdef.h"
+
+// JSON payloads shorter than this cannot hold a single entry
+#define CORPUS_GEN_MIN_JSON_LEN 192
+// share of txs, in percent, that have extraTo recipients
+#define CORPUS_GEN_EXTRATO_PERCENT 15
+
+typedef struct {
+    uint8_t txType;
+    uint8_t weight;
+} corpus_gen_mix_t;
+
+static const corpus_gen_mix_t mainnetMix[] = {
+        {MANTX_TXTYPE_NORMAL,      70},
+        {MANTX_TXTYPE_SCHEDULED,   4},
+        {MANTX_TXTYPE_REVERT,      4},
+        {MANTX_TXTYPE_AUTHORIZED,  8},
+        {MANTX_TXTYPE_CANCEL_AUTH, 4},
+        {MANTX_TXTYPE_CREATE_CURR, 10},
+};
+
+static uint64_t genState;
+
+static uint64_t gen_next() {
+    genState ^= genState >> 12;
+    genState ^= genState << 25;
+    genState ^= genState >> 27;
+    return genState * 0x2545F4914F6CDD1DULL;
+}
+
+// a value in [0, max], with every power of two range being as likely
+static uint32_t gen_skewed(uint32_t max) {
+    uint8_t bits = 0;
+    while (bits < 32 && (max >> bits) != 0) {
+        bits++;
+    }
+    const uint32_t range = (uint32_t) ((1ULL << (gen_next() % (bits + 1))) - 1);
+    const uint32_t v = (uint32_t) (gen_next() % ((uint64_t) range + 1));
+    return v > max ? max : v;
+}
+
+static uint8_t gen_txType(const uint8_t *types, uint8_t typeCount) {
+    if (typeCount > 0) {
+        return types[gen_next() % typeCount];
+    }
+
+    uint32_t total = 0;
+    for (size_t i = 0; i < sizeof(mainnetMix) / sizeof(mainnetMix[0]); i++) {
+        total += mainnetMix[i].weight;
+    }
+    uint32_t pick = (uint32_t) (gen_next() % total);
+    for (size_t i = 0; i < sizeof(mainnetMix) / sizeof(mainnetMix[0]); i++) {
+        if (pick < mainnetMix[i].weight) {
+            return mainnetMix[i].txType;
+        }
+        pick -= mainnetMix[i].weight;
+    }
+    return MANTX_TXTYPE_NORMAL;
+}
+
+static uint8_t gen_isJsonType(uint8_t txType) {
+    return txType == MANTX_TXTYPE_AUTHORIZED ||
+           txType == MANTX_TXTYPE_CANCEL_AUTH ||
+           txType == MANTX_TXTYPE_CREATE_CURR;
+}
+
+static uint8_t gen_parseTypes(char *list, uint8_t *types) {
+    uint8_t count = 0;
+    for (char *tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",")) {
+        const long t = strtol(tok, NULL, 10);
+        uint8_t supported = 0;
+        for (uint8_t i = 0; i < CORPUS_TXTYPE_COUNT; i++) {
+            supported |= corpus_txTypes[i] == t;
+        }
+        if (!supported || count == CORPUS_TXTYPE_COUNT) {
+            fprintf(stderr, "unsupported tx type %s\n", tok);
+            exit(EXIT_FAILURE);
+        }
+        types[count++] = (uint8_t) t;
+    }
+    return count;
+}
+
+static parser_error_t gen_check(const uint8_t *tx, uint16_t txLen) {
+    static parser_tx_t tx_obj;
+    parser_context_t ctx;
+    const parser_error_t err = parser_parse(&ctx, tx, txLen, &tx_obj);
+    if (err != parser_ok) {
+        return err;
+    }
+    return parser_validate(&ctx);
+}
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s -o FILE [-n COUNT] [-s SEED] [-d MAX_DATA_LEN] [-e MAX_EXTRATO] [-t TYPE,...]\n",
+            name);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+    const char *outPath = NULL;
+    unsigned long count = 100000;
+    unsigned long seed = 1;
+    unsigned long maxDataLen = 1024;
+    unsigned long maxExtraTo = 16;
+    uint8_t types[CORPUS_TXTYPE_COUNT];
+    uint8_t typeCount = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:n:s:d:e:t:")) != -1) {
+        switch (opt) {
+            case 'o':
+                outPath = optarg;
+                break;
+            case 'n':
+                count = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                maxDataLen = strtoul(optarg, NULL, 10);
+                break;
+            case 'e':
+                maxExtraTo = strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                typeCount = gen_parseTypes(optarg, types);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (outPath == NULL) {
+        usage(argv[0]);
+    }
+    if (maxDataLen > CORPUS_MAX_DATA_LEN) {
+        maxDataLen = CORPUS_MAX_DATA_LEN;
+    }
+    if (maxExtraTo > CORPUS_MAX_EXTRATO) {
+        maxExtraTo = CORPUS_MAX_EXTRATO;
+    }
+
+    FILE *f = fopen(outPath, "wb");
+    if (f == NULL || corpus_writeHeader(f) != CORPUS_OK) {
+        perror(outPath);
+        return EXIT_FAILURE;
+    }
+
+    genState = 0x9E3779B97F4A7C15ULL ^ seed;
+    static uint8_t tx[CORPUS_MAX_TX_LEN];
+    unsigned long typeCounts[256] = {0};
+    unsigned long long totalLen = 0;
+
+    for (unsigned long i = 0; i < count; i++) {
+        corpus_params_t params;
+        params.txType = gen_txType(types, typeCount);
+        params.dataLen = (uint16_t) gen_skewed((uint32_t) maxDataLen);
+        if (gen_isJsonType(params.txType) && params.dataLen < CORPUS_GEN_MIN_JSON_LEN) {
+            params.dataLen = maxDataLen < CORPUS_GEN_MIN_JSON_LEN ? (uint16_t) maxDataLen : CORPUS_GEN_MIN_JSON_LEN;
+        }
+        params.extraToCount = 0;
+        if (maxExtraTo > 0 && gen_next() % 100 < CORPUS_GEN_EXTRATO_PERCENT) {
+            params.extraToCount = (uint16_t) (1 + gen_skewed((uint32_t) maxExtraTo - 1));
+        }
+        params.seed = (uint32_t) (seed * 2654435761UL + i);
+
+        // shrink the tx until it fits in the device buffer and its fields fit in the pages of the device
+        uint32_t txLen;
+        parser_error_t err = parser_ok;
+        while (corpus_buildTx(&params, tx, sizeof(tx), &txLen) != RLP_NO_ERROR ||
+               (err = gen_check(tx, (uint16_t) txLen)) == (parser_error_t) RLP_ERROR_INVALID_PAGE) {
+            if (params.dataLen == 0 && params.extraToCount == 0) {
+                fprintf(stderr, "tx %lu could not be encoded\n", i);
+                return EXIT_FAILURE;
+            }
+            params.dataLen = params.dataLen > 3 ? params.dataLen / 2 : 0;
+            params.extraToCount /= 2;
+        }
+
+        // the corpus only holds txs that the app accepts
+        if (err != parser_ok) {
+            // RLP errors come through as negative codes without a description
+            fprintf(stderr, "tx %lu (type %s) is rejected by the parser: %s (%d)\n",
+                    i, corpus_txTypeName(params.txType), parser_getErrorDescription(err), (int) err);
+            return EXIT_FAILURE;
+        }
+
+        if (corpus_writeTx(f, tx, (uint16_t) txLen) != CORPUS_OK) {
+            perror(outPath);
+            return EXIT_FAILURE;
+        }
+        typeCounts[params.txType]++;
+        totalLen += txLen;
+    }
+
+    if (fclose(f) != 0) {
+        perror(outPath);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stderr, "%lu txs, %llu bytes\n", count, totalLen);
+    for (uint8_t i = 0; i < CORPUS_TXTYPE_COUNT; i++) {
+        fprintf(stderr, "  %-10s %lu\n", corpus_txTypeName(corpus_txTypes[i]), typeCounts[corpus_txTypes[i]]);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "rlp_prefix_table.h"
+#include "lib/rlp.h"
+
+// Prefix byte classification
+typedef struct {
+    uint8_t kind;
+    uint8_t headerLen;      // 0 for single bytes, 1 + length of the length for long forms
+    uint8_t len;            // value length of short forms
+    uint8_t itemLen;        // whole item size of single bytes and short forms, 0 for long forms
+} rlp_prefix_t;
+
+#define RLP_P_BYTE      {RLP_KIND_BYTE, 0, 0, 1}
+#define RLP_P_STR(L)    {RLP_KIND_STRING, 1, L, 1 + (L)}
+#define RLP_P_LSTR(LL)  {RLP_KIND_STRING, 1 + (LL), 0, 0}
+#define RLP_P_LIST(L)   {RLP_KIND_LIST, 1, L, 1 + (L)}
+#define RLP_P_LLIST(LL) {RLP_KIND_LIST, 1 + (LL), 0, 0}
+
+static const rlp_prefix_t rlp_prefixTable[256] = {
+    // 0x00 - 0x7f: single byte, it is its own value
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE, RLP_P_BYTE,
+    // 0x80 - 0xb7: string of up to 55 bytes
+    RLP_P_STR(0), RLP_P_STR(1), RLP_P_STR(2), RLP_P_STR(3), RLP_P_STR(4), RLP_P_STR(5), RLP_P_STR(6), RLP_P_STR(7),
+    RLP_P_STR(8), RLP_P_STR(9), RLP_P_STR(10), RLP_P_STR(11), RLP_P_STR(12), RLP_P_STR(13), RLP_P_STR(14), RLP_P_STR(15),
+    RLP_P_STR(16), RLP_P_STR(17), RLP_P_STR(18), RLP_P_STR(19), RLP_P_STR(20), RLP_P_STR(21), RLP_P_STR(22), RLP_P_STR(23),
+    RLP_P_STR(24), RLP_P_STR(25), RLP_P_STR(26), RLP_P_STR(27), RLP_P_STR(28), RLP_P_STR(29), RLP_P_STR(30), RLP_P_STR(31),
+    RLP_P_STR(32), RLP_P_STR(33), RLP_P_STR(34), RLP_P_STR(35), RLP_P_STR(36), RLP_P_STR(37), RLP_P_STR(38), RLP_P_STR(39),
+    RLP_P_STR(40), RLP_P_STR(41), RLP_P_STR(42), RLP_P_STR(43), RLP_P_STR(44), RLP_P_STR(45), RLP_P_STR(46), RLP_P_STR(47),
+    RLP_P_STR(48), RLP_P_STR(49), RLP_P_STR(50), RLP_P_STR(51), RLP_P_STR(52), RLP_P_STR(53), RLP_P_STR(54), RLP_P_STR(55),
+    // 0xb8 - 0xbf: longer string, followed by its length in 1-8 bytes
+    RLP_P_LSTR(1), RLP_P_LSTR(2), RLP_P_LSTR(3), RLP_P_LSTR(4), RLP_P_LSTR(5), RLP_P_LSTR(6), RLP_P_LSTR(7), RLP_P_LSTR(8),
+    // 0xc0 - 0xf7: list of up to 55 bytes
+    RLP_P_LIST(0), RLP_P_LIST(1), RLP_P_LIST(2), RLP_P_LIST(3), RLP_P_LIST(4), RLP_P_LIST(5), RLP_P_LIST(6), RLP_P_LIST(7),
+    RLP_P_LIST(8), RLP_P_LIST(9), RLP_P_LIST(10), RLP_P_LIST(11), RLP_P_LIST(12), RLP_P_LIST(13), RLP_P_LIST(14), RLP_P_LIST(15),
+    RLP_P_LIST(16), RLP_P_LIST(17), RLP_P_LIST(18), RLP_P_LIST(19), RLP_P_LIST(20), RLP_P_LIST(21), RLP_P_LIST(22), RLP_P_LIST(23),
+    RLP_P_LIST(24), RLP_P_LIST(25), RLP_P_LIST(26), RLP_P_LIST(27), RLP_P_LIST(28), RLP_P_LIST(29), RLP_P_LIST(30), RLP_P_LIST(31),
+    RLP_P_LIST(32), RLP_P_LIST(33), RLP_P_LIST(34), RLP_P_LIST(35), RLP_P_LIST(36), RLP_P_LIST(37), RLP_P_LIST(38), RLP_P_LIST(39),
+    RLP_P_LIST(40), RLP_P_LIST(41), RLP_P_LIST(42), RLP_P_LIST(43), RLP_P_LIST(44), RLP_P_LIST(45), RLP_P_LIST(46), RLP_P_LIST(47),
+    RLP_P_LIST(48), RLP_P_LIST(49), RLP_P_LIST(50), RLP_P_LIST(51), RLP_P_LIST(52), RLP_P_LIST(53), RLP_P_LIST(54), RLP_P_LIST(55),
+    // 0xf8 - 0xff: longer list, followed by its length in 1-8 bytes
+    RLP_P_LLIST(1), RLP_P_LLIST(2), RLP_P_LLIST(3), RLP_P_LLIST(4), RLP_P_LLIST(5), RLP_P_LLIST(6), RLP_P_LLIST(7), RLP_P_LLIST(8),
+};
+
+int16_t rlp_decodeHeaderTable(const uint8_t *data,
+                              const uint8_t *end,
+                              uint8_t *kind,
+                              uint16_t *len,
+                              uint16_t *valueOffset) {
+    if (data >= end)
+        return RLP_ERROR_TRUNCATED;
+
+    const rlp_prefix_t *prefix = &rlp_prefixTable[*data];
+    *kind = prefix->kind;
+    *len = prefix->len;
+    *valueOffset = prefix->headerLen;
+
+    if (prefix->itemLen != 0) {
+        // single bytes and short forms
+        return prefix->itemLen;
+    }
+
+    // lengths must fit in uint16_t
+    if (prefix->headerLen > 1 + sizeof(uint16_t))
+        return RLP_ERROR_INVALID_VALUE_LEN;
+    if (end - data < prefix->headerLen)
+        return RLP_ERROR_TRUNCATED;
+
+    *len = data[1];
+    if (prefix->headerLen == 3) {
+        *len = (*len << 8u) | data[2];
+    }
+
+    const uint32_t itemLen = (uint32_t) prefix->headerLen + *len;
+    if (itemLen > INT16_MAX)
+        return RLP_ERROR_INVALID_VALUE_LEN;
+
+    return itemLen;
+}
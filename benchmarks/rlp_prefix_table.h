@@ -0,0 +1,36 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Prefix classification by a 256-entry table, the alternative to the range comparisons of rlp.c.
+// Only used to compare both ways in benchmarks.cpp
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// same contract and results as rlp_decodeHeader
+int16_t rlp_decodeHeaderTable(const uint8_t *data,
+                              const uint8_t *end,
+                              uint8_t *kind,
+                              uint16_t *len,
+                              uint16_t *valueOffset);
+
+#ifdef __cplusplus
+}
+#endif
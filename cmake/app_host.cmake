@@ -0,0 +1,44 @@
+#*******************************************************************************
+#*   (c) 2019 ZondaX GmbH
+#*
+#*  Licensed under the Apache License, Version 2.0 (the "License");
+#*  you may not use this file except in compliance with the License.
+#*  You may obtain a copy of the License at
+#*
+#*      http://www.apache.org/licenses/LICENSE-2.0
+#*
+#*  Unless required by applicable law or agreed to in writing, software
+#*  distributed under the License is distributed on an "AS IS" BASIS,
+#*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#*  See the License for the specific language governing permissions and
+#*  limitations under the License.
+#********************************************************************************
+# App code built for the host, shared by the tests and the benchmarks
+# APP_DIR must point to the root of the repo
+
+set(ZXLIB_DIR ${APP_DIR}/deps/ledger-zxlib)
+
+file(GLOB_RECURSE ZXLIB_SRC
+        ${ZXLIB_DIR}/src/*.c
+        )
+
+file(GLOB_RECURSE APP_SRC
+        ${APP_DIR}/src/lib/crypto.c
+        ${APP_DIR}/src/lib/json.c
+        ${APP_DIR}/src/lib/mantx_encode.c
+        ${APP_DIR}/src/lib/parser.c
+        ${APP_DIR}/src/lib/parser_impl.c
+        ${APP_DIR}/src/lib/rlp.c
+        ${APP_DIR}/src/utils/*.c
+        ${APP_DIR}/src/mocks/*.c
+        )
+
+set(APP_INCLUDE_DIRS
+        ${APP_DIR}/src
+        ${APP_DIR}/src/lib
+        ${APP_DIR}/src/utils
+        ${ZXLIB_DIR}/include
+        )
+
+add_library(app_host STATIC ${APP_SRC} ${ZXLIB_SRC})
+target_include_directories(app_host PUBLIC ${APP_INCLUDE_DIRS})
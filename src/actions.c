@@ -25,11 +25,8 @@
 uint8_t app_sign() {
     uint8_t *signature = G_io_apdu_buffer;
 
-    // Skip first byte (context length)
-    const uint8_t *message = tx_get_buffer();
-    const uint16_t messageLength = tx_get_buffer_length();
-
-    return crypto_sign(signature, IO_APDU_BUFFER_SIZE - 2, message, messageLength);
+    // The message digest was computed while the tx was uploaded
+    return crypto_sign(signature, IO_APDU_BUFFER_SIZE - 2);
 }
 
 uint8_t app_fill_address() {
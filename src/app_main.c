@@ -116,10 +116,12 @@ bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
     }
 
     uint32_t added;
+    const char *error_msg;
     switch (payloadType) {
         case 0:
             tx_initialize();
             tx_reset();
+            crypto_hashInit();
             extractBip44(rx, OFFSET_DATA);
             return false;
         case 1:
@@ -127,12 +129,24 @@ bool process_chunk(volatile uint32_t *tx, uint32_t rx) {
             if (added != rx - OFFSET_DATA) {
                 THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
             }
+            crypto_hashUpdate(&(G_io_apdu_buffer[OFFSET_DATA]), rx - OFFSET_DATA);
+
+            // Parse what has arrived so far so malformed data is rejected early
+            error_msg = tx_parse_chunk();
+            if (error_msg != NULL) {
+                int error_msg_length = strlen(error_msg);
+                MEMCPY(G_io_apdu_buffer, error_msg, error_msg_length);
+                *tx += (error_msg_length);
+                THROW(APDU_CODE_DATA_INVALID);
+            }
             return false;
         case 2:
             added = tx_append(&(G_io_apdu_buffer[OFFSET_DATA]), rx - OFFSET_DATA);
             if (added != rx - OFFSET_DATA) {
                 THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
             }
+            crypto_hashUpdate(&(G_io_apdu_buffer[OFFSET_DATA]), rx - OFFSET_DATA);
+            crypto_hashFinal();
             return true;
     }
 
@@ -23,6 +23,9 @@
 #include "utils/utils.h"
 
 uint32_t bip44Path[BIP44_LEN_DEFAULT];
+uint8_t message_digest[32];
+// set by crypto_hashFinal, a digest is signed at most once and only when the whole message was hashed
+static bool message_digest_ready = false;
 
 void keccak(uint8_t *out, size_t out_len, uint8_t *in, size_t in_len);
 
@@ -62,24 +65,39 @@ void crypto_extractPublicKey(uint32_t bip44Path[BIP44_LEN_DEFAULT], uint8_t *pub
     MEMCPY(pubKey, cx_publicKey.W, 65);
 }
 
+cx_sha3_t message_hash;
+
+void crypto_hashInit() {
+    message_digest_ready = false;
+    cx_keccak_init(&message_hash, 256);
+}
+
+void crypto_hashUpdate(const uint8_t *data, uint16_t dataLen) {
+    message_digest_ready = false;
+    cx_hash((cx_hash_t *) &message_hash, 0, (uint8_t *) data, dataLen, NULL, 0);
+}
+
+void crypto_hashFinal() {
+    cx_hash((cx_hash_t *) &message_hash, CX_LAST, NULL, 0, message_digest, sizeof(message_digest));
+    message_digest_ready = true;
+}
+
 #define DER_OFFSET 65
 
 uint16_t crypto_sign(uint8_t *signature,
-                     uint16_t signatureMaxlen,
-                     const uint8_t *message,
-                     uint16_t messageLength) {
+                     uint16_t signatureMaxlen) {
 
     if (signatureMaxlen < DER_OFFSET + 80) {
         return 0;
     }
+    if (!message_digest_ready) {
+        return 0;
+    }
+    message_digest_ready = false;
 
-    uint8_t messageDigest[CX_SHA256_SIZE];
     int signatureLength;
     uint8_t *der_signature = signature + DER_OFFSET;
 
-    // Hash it
-    keccak(messageDigest, sizeof(messageDigest), (uint8_t *) message, messageLength);
-
     cx_ecfp_private_key_t cx_privateKey;
     uint8_t privateKeyData[32];
     BEGIN_TRY
@@ -103,7 +121,7 @@ uint16_t crypto_sign(uint8_t *signature,
             signatureLength = cx_eddsa_sign(&cx_privateKey,
                                             CX_RND_RFC6979 | CX_LAST,
                                             CX_SHA256,
-                                            messageDigest,
+                                            message_digest,
                                             CX_SHA256_SIZE,
                                             NULL,
                                             0,
@@ -173,16 +191,32 @@ void keccak(uint8_t *out, size_t out_len, uint8_t *in, size_t in_len) {
     keccak_hash(out, out_len, in, in_len, 136, 0x01);
 }
 
+keccak_ctx_t message_hash;
+
+void crypto_hashInit() {
+    message_digest_ready = false;
+    keccak_init(&message_hash, 136, 0x01);
+}
+
+void crypto_hashUpdate(const uint8_t *data, uint16_t dataLen) {
+    message_digest_ready = false;
+    keccak_update(&message_hash, data, dataLen);
+}
+
+void crypto_hashFinal() {
+    keccak_final(&message_hash, message_digest, sizeof(message_digest));
+    message_digest_ready = true;
+}
+
 void crypto_extractPublicKey(uint32_t path[BIP44_LEN_DEFAULT], uint8_t *pubKey) {
     // Empty version for non-Ledger devices
     MEMZERO(pubKey, 32);
 }
 
 uint16_t crypto_sign(uint8_t *signature,
-                     uint16_t signatureMaxlen,
-                     const uint8_t *message,
-                     uint16_t messageLen) {
+                     uint16_t signatureMaxlen) {
     // Empty version for non-Ledger devices
+    message_digest_ready = false;
     return 0;
 }
 
@@ -205,7 +239,7 @@ uint8_t manAddressFromEthAddr(char *manAddress, uint8_t *ethAddress) {
     char *p = manAddress + 4;
 
     size_t outlen = 100;
-    encode_base58(ethAddress, 20, (unsigned char *) p, &outlen);
+    encode_base58_20(ethAddress, (unsigned char *) p, &outlen);
     p += outlen;
 
     // calculate CRC
@@ -217,6 +251,92 @@ uint8_t manAddressFromEthAddr(char *manAddress, uint8_t *ethAddress) {
     return (uint8_t) (p - manAddress);
 }
 
+#define MAN_ADDR_PREFIX         "MAN."
+#define MAN_ADDR_PREFIX_LEN     4
+#define MAN_ADDR_LEN            20
+#define MAN_ADDR_LIMB_COUNT     (MAN_ADDR_LEN / 4)
+
+bool manAddressDecode(uint8_t *ethAddress, const char *manAddress, uint16_t manAddressLen) {
+    // prefix + base58 payload + check character
+    if (manAddressLen < MAN_ADDR_PREFIX_LEN + 2) {
+        return false;
+    }
+
+    if (MEMCMP(manAddress, MAN_ADDR_PREFIX, MAN_ADDR_PREFIX_LEN) != 0) {
+        return false;
+    }
+    uint8_t crc = crc8_update(0, (const uint8_t *) manAddress, MAN_ADDR_PREFIX_LEN);
+
+    // accumulate the payload as a 160 bit big endian number
+    uint32_t limbs[MAN_ADDR_LIMB_COUNT] = {0};
+    uint16_t leadingOnes = 0;
+    bool leading = true;
+
+    for (uint16_t i = MAN_ADDR_PREFIX_LEN; i < manAddressLen - 1; i++) {
+        const int digit = decode_base58_digit(manAddress[i]);
+        if (digit < 0) {
+            return false;
+        }
+        crc = crc8_update(crc, (const uint8_t *) manAddress + i, 1);
+
+        if (leading && digit == 0) {
+            leadingOnes++;
+            continue;
+        }
+        leading = false;
+
+        uint64_t carry = (uint64_t) digit;
+        for (int8_t j = MAN_ADDR_LIMB_COUNT - 1; j >= 0; j--) {
+            carry += (uint64_t) limbs[j] * 58;
+            limbs[j] = (uint32_t) carry;
+            carry >>= 32u;
+        }
+        if (carry != 0) {
+            // does not fit in 20 bytes
+            return false;
+        }
+    }
+
+    if (manAddress[manAddressLen - 1] != encode_base58_clip(crc)) {
+        return false;
+    }
+
+    for (uint8_t j = 0; j < MAN_ADDR_LIMB_COUNT; j++) {
+        ethAddress[4 * j] = (uint8_t) (limbs[j] >> 24u);
+        ethAddress[4 * j + 1] = (uint8_t) (limbs[j] >> 16u);
+        ethAddress[4 * j + 2] = (uint8_t) (limbs[j] >> 8u);
+        ethAddress[4 * j + 3] = (uint8_t) limbs[j];
+    }
+
+    // base58 keeps one leading '1' per leading zero byte, so the encoding is canonical only if they match
+    uint16_t zeroBytes = 0;
+    while (zeroBytes < MAN_ADDR_LEN && ethAddress[zeroBytes] == 0) {
+        zeroBytes++;
+    }
+
+    return zeroBytes == leadingOnes;
+}
+
+bool manAddressValidate(const char *manAddress, uint16_t manAddressLen) {
+    uint8_t ethAddress[MAN_ADDR_LEN];
+    return manAddressDecode(ethAddress, manAddress, manAddressLen);
+}
+
+uint32_t manAddressValidateBatch(const char *const *manAddresses,
+                                 const uint16_t *manAddressLens,
+                                 uint32_t count,
+                                 uint8_t *valid) {
+    uint8_t ethAddress[MAN_ADDR_LEN];
+    uint32_t validCount = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        valid[i] = manAddressDecode(ethAddress, manAddresses[i], manAddressLens[i]) ? 1 : 0;
+        validCount += valid[i];
+    }
+
+    return validCount;
+}
+
 uint16_t crypto_fillAddress(uint8_t *buffer, uint16_t buffer_len) {
     if (buffer_len < PK_LEN + 50) {
         return 0;
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <zxmacros.h>
+#include <stdbool.h>
 #include "coin.h"
 
 #ifdef __cplusplus
@@ -30,15 +31,35 @@ extern uint32_t bip44Path[BIP44_LEN_DEFAULT];
 
 uint16_t crypto_fillAddress(uint8_t *buffer, uint16_t buffer_len);
 
+// The message is hashed chunk by chunk while it is uploaded
+void crypto_hashInit();
+
+void crypto_hashUpdate(const uint8_t *data, uint16_t dataLen);
+
+void crypto_hashFinal();
+
+// Signs the digest produced by crypto_hashFinal. It returns 0 if crypto_hashFinal has not run since
+// the last crypto_hashInit or crypto_hashUpdate, or if that digest was already signed
 uint16_t crypto_sign(uint8_t *signature,
-                     uint16_t signatureMaxlen,
-                     const uint8_t *message,
-                     uint16_t messageLen);
+                     uint16_t signatureMaxlen);
 
 void ethAddressFromPubKey(uint8_t *ethAddress, uint8_t *pubkey);
 
 uint8_t manAddressFromEthAddr(char *manAddress, uint8_t *ethAddress);
 
+// Checks the MAN. prefix, base58 alphabet and crc8 check character in a single pass
+// and extracts the 20 bytes address. It returns false if the address is not valid
+bool manAddressDecode(uint8_t *ethAddress, const char *manAddress, uint16_t manAddressLen);
+
+bool manAddressValidate(const char *manAddress, uint16_t manAddressLen);
+
+// Validates count addresses. valid[i] is set to 1 for valid addresses and 0 otherwise
+// It returns the number of valid addresses
+uint32_t manAddressValidateBatch(const char *const *manAddresses,
+                                 const uint16_t *manAddressLens,
+                                 uint32_t count,
+                                 uint8_t *valid);
+
 #ifdef __cplusplus
 }
 #endif
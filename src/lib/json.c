@@ -0,0 +1,177 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "json.h"
+
+static bool json_isSpace(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static uint16_t json_skipSpaces(const json_iter_t *iter, uint16_t offset) {
+    while (offset < iter->end && json_isSpace(iter->data[offset])) {
+        offset++;
+    }
+    return offset;
+}
+
+// offset is at the opening quote. Returns the offset after the closing quote
+static int8_t json_skipString(const json_iter_t *iter, uint16_t *offset) {
+    uint16_t p = *offset + 1;
+    while (p < iter->end) {
+        const uint8_t c = iter->data[p];
+        if (c == '"') {
+            *offset = p + 1;
+            return JSON_NO_ERROR;
+        }
+        if (c < 0x20)
+            return JSON_ERROR_SYNTAX;
+        // the escaped char is skipped, whatever it is
+        p += (c == '\\') ? 2 : 1;
+    }
+    return JSON_ERROR_SYNTAX;
+}
+
+// numbers, true, false and null
+static bool json_isScalarChar(uint8_t c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+// offset is at the first char of the value. Nested objects and arrays are skipped by
+// counting brackets, with one bit per level to check that they match
+static int8_t json_skipValue(const json_iter_t *iter, uint16_t *offset) {
+    uint32_t isObject = 0;
+    uint8_t depth = 0;
+    uint16_t p = *offset;
+
+    do {
+        p = json_skipSpaces(iter, p);
+        if (p >= iter->end)
+            return JSON_ERROR_SYNTAX;
+
+        const uint8_t c = iter->data[p];
+        switch (c) {
+            case '"': {
+                const int8_t err = json_skipString(iter, &p);
+                if (err != JSON_NO_ERROR)
+                    return err;
+                break;
+            }
+            case '{':
+            case '[':
+                if (depth == JSON_MAX_DEPTH)
+                    return JSON_ERROR_TOO_DEEP;
+                isObject = (isObject << 1u) | (c == '{' ? 1u : 0u);
+                depth++;
+                p++;
+                break;
+            case '}':
+            case ']':
+                if (depth == 0 || (isObject & 1u) != (c == '}' ? 1u : 0u))
+                    return JSON_ERROR_SYNTAX;
+                isObject >>= 1u;
+                depth--;
+                p++;
+                break;
+            case ',':
+            case ':':
+                // separators are only valid inside a container
+                if (depth == 0)
+                    return JSON_ERROR_SYNTAX;
+                p++;
+                break;
+            default:
+                if (!json_isScalarChar(c))
+                    return JSON_ERROR_SYNTAX;
+                while (p < iter->end && json_isScalarChar(iter->data[p])) {
+                    p++;
+                }
+                break;
+        }
+    } while (depth > 0);
+
+    *offset = p;
+    return JSON_NO_ERROR;
+}
+
+int8_t json_objectInit(json_iter_t *iter, const uint8_t *data, uint16_t offset, uint16_t len) {
+    iter->data = data;
+    iter->end = offset + len;
+    iter->first = 1;
+
+    offset = json_skipSpaces(iter, offset);
+    if (offset >= iter->end || data[offset] != '{')
+        return JSON_ERROR_SYNTAX;
+
+    iter->offset = offset + 1;
+    return JSON_NO_ERROR;
+}
+
+int8_t json_objectNext(json_iter_t *iter, json_span_t *key, json_span_t *value) {
+    uint16_t p = json_skipSpaces(iter, iter->offset);
+    if (p >= iter->end)
+        return JSON_ERROR_SYNTAX;
+
+    if (iter->data[p] == '}')
+        return JSON_ERROR_NO_MORE_ITEMS;
+
+    if (!iter->first) {
+        if (iter->data[p] != ',')
+            return JSON_ERROR_SYNTAX;
+        p = json_skipSpaces(iter, p + 1);
+    }
+
+    // "key"
+    if (p >= iter->end || iter->data[p] != '"')
+        return JSON_ERROR_SYNTAX;
+    key->offset = p + 1;
+    int8_t err = json_skipString(iter, &p);
+    if (err != JSON_NO_ERROR)
+        return err;
+    key->len = p - 1 - key->offset;
+
+    // :
+    p = json_skipSpaces(iter, p);
+    if (p >= iter->end || iter->data[p] != ':')
+        return JSON_ERROR_SYNTAX;
+    p = json_skipSpaces(iter, p + 1);
+
+    // value
+    value->offset = p;
+    err = json_skipValue(iter, &p);
+    if (err != JSON_NO_ERROR)
+        return err;
+    value->len = p - value->offset;
+    if (iter->data[value->offset] == '"') {
+        value->offset++;
+        value->len -= 2;
+    }
+
+    iter->offset = p;
+    iter->first = 0;
+    return JSON_NO_ERROR;
+}
+
+int8_t json_objectFinish(const json_iter_t *iter) {
+    uint16_t p = json_skipSpaces(iter, iter->offset);
+    if (p >= iter->end || iter->data[p] != '}')
+        return JSON_ERROR_SYNTAX;
+
+    p = json_skipSpaces(iter, p + 1);
+    if (p != iter->end)
+        return JSON_ERROR_SYNTAX;
+
+    return JSON_NO_ERROR;
+}
@@ -0,0 +1,60 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <zxmacros.h>
+
+#define JSON_NO_ERROR 0
+#define JSON_ERROR_SYNTAX  -1
+#define JSON_ERROR_TOO_DEEP  -2
+#define JSON_ERROR_NO_MORE_ITEMS  -3
+
+// nesting levels that can be skipped inside a value
+#define JSON_MAX_DEPTH 32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A piece of the buffer. Strings do not include their quotes and escapes are kept as they are
+typedef struct {
+    uint16_t offset;
+    uint16_t len;
+} json_span_t;
+
+// Walks the members of a JSON object in place, one at a time. Nothing is copied
+// Only offsets are kept, so an iterator can be resumed from a saved offset
+typedef struct {
+    const uint8_t *data;
+    uint16_t offset;        // right after the opening brace or the last value
+    uint16_t end;
+    uint8_t first;          // no member has been read yet
+} json_iter_t;
+
+// prepares an iterator over the object in data[offset, offset + len)
+int8_t json_objectInit(json_iter_t *iter, const uint8_t *data, uint16_t offset, uint16_t len);
+
+// reads the next member. Returns JSON_ERROR_NO_MORE_ITEMS at the closing brace
+int8_t json_objectNext(json_iter_t *iter, json_span_t *key, json_span_t *value);
+
+// checks that there is nothing but whitespace after the closing brace
+int8_t json_objectFinish(const json_iter_t *iter);
+
+#ifdef __cplusplus
+}
+#endif
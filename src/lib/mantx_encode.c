@@ -0,0 +1,111 @@
+/*******************************************************************************
+*  (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include <zxmacros.h>
+#include "mantx_encode.h"
+
+#define CHECK_RLP_ERR(CALL) { \
+    int8_t err = CALL;  \
+    if (err != RLP_NO_ERROR) return err;}
+
+// Payload sizes of every list in the tx, from the innermost outwards
+typedef struct {
+    uint32_t extraToList;
+    uint32_t extraInner;
+    uint32_t extraOuter;
+    uint32_t root;
+} mantx_sizes_t;
+
+static uint32_t mantx_extraToPayloadLen(const mantx_extrato_t *e) {
+    return rlp_bytesEncodedLen((const uint8_t *) e->to, e->toLen) +
+           rlp_uint256EncodedLen(&e->amount) +
+           rlp_bytesEncodedLen(e->payload, e->payloadLen);
+}
+
+static void mantx_computeSizes(const mantx_t *tx, mantx_sizes_t *sizes) {
+    sizes->extraToList = 0;
+    for (uint16_t i = 0; i < tx->extraToCount; i++) {
+        sizes->extraToList += rlp_listEncodedLen(mantx_extraToPayloadLen(tx->extraTo + i));
+    }
+
+    sizes->extraInner = rlp_uint64EncodedLen(tx->txType) +
+                        rlp_uint64EncodedLen(tx->lockHeight) +
+                        rlp_listEncodedLen(sizes->extraToList);
+    sizes->extraOuter = rlp_listEncodedLen(sizes->extraInner);
+
+    sizes->root = rlp_uint64EncodedLen(tx->nonce) +
+                  rlp_uint256EncodedLen(&tx->gasPrice) +
+                  rlp_uint256EncodedLen(&tx->gasLimit) +
+                  rlp_bytesEncodedLen((const uint8_t *) tx->to, tx->toLen) +
+                  rlp_uint256EncodedLen(&tx->value) +
+                  rlp_bytesEncodedLen(tx->data, tx->dataLen) +
+                  rlp_uint64EncodedLen(tx->v) +
+                  rlp_uint256EncodedLen(&tx->r) +
+                  rlp_uint256EncodedLen(&tx->s) +
+                  rlp_uint64EncodedLen(tx->enterType) +
+                  rlp_uint64EncodedLen(tx->isEntrustTx) +
+                  rlp_uint64EncodedLen(tx->commitTime) +
+                  rlp_listEncodedLen(sizes->extraOuter);
+}
+
+uint32_t mantx_encodedLen(const mantx_t *tx) {
+    mantx_sizes_t sizes;
+    mantx_computeSizes(tx, &sizes);
+    return rlp_listEncodedLen(sizes.root);
+}
+
+int8_t mantx_encode(const mantx_t *tx, uint8_t *out, uint32_t outLen, uint32_t *written) {
+    mantx_sizes_t sizes;
+    mantx_computeSizes(tx, &sizes);
+
+    *written = 0;
+    if (outLen < rlp_listEncodedLen(sizes.root))
+        return RLP_ERROR_BUFFER_TOO_SMALL;
+
+    rlp_encoder_t enc;
+    rlp_encoderInit(&enc, out, outLen);
+
+    CHECK_RLP_ERR(rlp_writeListHeader(&enc, sizes.root))
+    CHECK_RLP_ERR(rlp_writeUInt64(&enc, tx->nonce))
+    CHECK_RLP_ERR(rlp_writeUInt256(&enc, &tx->gasPrice))
+    CHECK_RLP_ERR(rlp_writeUInt256(&enc, &tx->gasLimit))
+    CHECK_RLP_ERR(rlp_writeBytes(&enc, (const uint8_t *) tx->to, tx->toLen))
+    CHECK_RLP_ERR(rlp_writeUInt256(&enc, &tx->value))
+    CHECK_RLP_ERR(rlp_writeBytes(&enc, tx->data, tx->dataLen))
+    CHECK_RLP_ERR(rlp_writeUInt64(&enc, tx->v))
+    CHECK_RLP_ERR(rlp_writeUInt256(&enc, &tx->r))
+    CHECK_RLP_ERR(rlp_writeUInt256(&enc, &tx->s))
+    CHECK_RLP_ERR(rlp_writeUInt64(&enc, tx->enterType))
+    CHECK_RLP_ERR(rlp_writeUInt64(&enc, tx->isEntrustTx))
+    CHECK_RLP_ERR(rlp_writeUInt64(&enc, tx->commitTime))
+
+    // extra is a list with a single list inside: [[txType, lockHeight, [extraTo...]]]
+    CHECK_RLP_ERR(rlp_writeListHeader(&enc, sizes.extraOuter))
+    CHECK_RLP_ERR(rlp_writeListHeader(&enc, sizes.extraInner))
+    CHECK_RLP_ERR(rlp_writeUInt64(&enc, tx->txType))
+    CHECK_RLP_ERR(rlp_writeUInt64(&enc, tx->lockHeight))
+    CHECK_RLP_ERR(rlp_writeListHeader(&enc, sizes.extraToList))
+    for (uint16_t i = 0; i < tx->extraToCount; i++) {
+        const mantx_extrato_t *e = tx->extraTo + i;
+        CHECK_RLP_ERR(rlp_writeListHeader(&enc, mantx_extraToPayloadLen(e)))
+        CHECK_RLP_ERR(rlp_writeBytes(&enc, (const uint8_t *) e->to, e->toLen))
+        CHECK_RLP_ERR(rlp_writeUInt256(&enc, &e->amount))
+        CHECK_RLP_ERR(rlp_writeBytes(&enc, e->payload, e->payloadLen))
+    }
+
+    *written = enc.len;
+    return RLP_NO_ERROR;
+}
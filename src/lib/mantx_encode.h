@@ -0,0 +1,67 @@
+/*******************************************************************************
+*  (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+#include "rlp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Buffers are referenced, not copied. They must outlive the encoding
+typedef struct {
+    const char *to;             // recipient address, as text
+    uint16_t toLen;
+    uint256_t amount;
+    const uint8_t *payload;
+    uint16_t payloadLen;
+} mantx_extrato_t;
+
+typedef struct {
+    uint64_t nonce;
+    uint256_t gasPrice;
+    uint256_t gasLimit;
+    const char *to;             // recipient address, as text
+    uint16_t toLen;
+    uint256_t value;
+    const uint8_t *data;
+    uint16_t dataLen;
+    uint8_t v;                  // chain id for unsigned txs (EIP155)
+    uint256_t r;
+    uint256_t s;
+    uint64_t enterType;
+    uint64_t isEntrustTx;
+    uint64_t commitTime;
+    // extra
+    uint8_t txType;
+    uint64_t lockHeight;
+    const mantx_extrato_t *extraTo;
+    uint16_t extraToCount;
+} mantx_t;
+
+// returns the exact size of the encoded tx
+uint32_t mantx_encodedLen(const mantx_t *tx);
+
+// encodes the tx in the same layout that parser_read expects
+// out must have room for at least mantx_encodedLen(tx) bytes
+int8_t mantx_encode(const mantx_t *tx, uint8_t *out, uint32_t outLen, uint32_t *written);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,6 +15,7 @@
 ********************************************************************************/
 
 #include <stdio.h>
+#include <string.h>
 #include <zxmacros.h>
 #include <bech32.h>
 #include <utils/utils.h>
@@ -32,29 +33,101 @@ void __assert_fail(const char * assertion, const char * file, unsigned int line,
 }
 #endif
 
-parser_error_t parser_parse(parser_context_t *ctx, const uint8_t *data, uint16_t dataLen) {
+void parser_parseStart(parser_tx_t *tx_obj) {
+    parser_readStart(tx_obj);
+}
+
+parser_error_t parser_parseChunk(parser_context_t *ctx, const uint8_t *data, uint16_t dataLen, parser_tx_t *tx_obj) {
+    ctx->tx_obj = tx_obj;
+    CHECK_PARSER_ERR(parser_init(ctx, data, dataLen))
+    return parser_readChunk(ctx, ctx->tx_obj);
+}
+
+parser_error_t parser_parseFinish(parser_context_t *ctx, const uint8_t *data, uint16_t dataLen, parser_tx_t *tx_obj) {
+    ctx->tx_obj = tx_obj;
+    // pages of long fields are laid out once for the value line of the device
+    tx_obj->pageWidth = MAX_CHARS_PER_VALUE1_LINE;
     CHECK_PARSER_ERR(parser_init(ctx, data, dataLen))
-    return parser_read(ctx, &parser_tx_obj);
+    return parser_read(ctx, ctx->tx_obj);
+}
+
+parser_error_t parser_parse(parser_context_t *ctx, const uint8_t *data, uint16_t dataLen, parser_tx_t *tx_obj) {
+    // tx_obj may come from anywhere, nothing in it is trusted
+    parser_readStart(tx_obj);
+    return parser_parseFinish(ctx, data, dataLen, tx_obj);
 }
 
 parser_error_t parser_validate(const parser_context_t *ctx) {
-    CHECK_PARSER_ERR(_validateTx(ctx, &parser_tx_obj))
+    if (ctx->tx_obj == NULL) {
+        return parser_no_data;
+    }
 
-    uint8_t numItems = parser_getNumItems(ctx);
+    // Check-only: items are not rendered here
+    return _validateTx(ctx, ctx->tx_obj);
+}
 
-    char tmpKey[40];
-    char tmpVal[40];
+static parser_error_t parser_readUInt64Field(const parser_context_t *ctx, uint8_t fieldIdx, uint64_t *value) {
+    const parser_tx_t *v = ctx->tx_obj;
+    int8_t err = rlp_readUInt64(ctx->buffer, v->nodes + v->rootFieldsIdx + fieldIdx, value);
+    if (err == RLP_ERROR_OVERFLOW)
+        return parser_unexpected_field;
+    return err;
+}
 
-    for (uint8_t idx = 0; idx < numItems; idx++) {
-        uint8_t pageCount;
-        CHECK_PARSER_ERR(parser_getItem(ctx, idx, tmpKey, sizeof(tmpKey), tmpVal, sizeof(tmpVal), 0, &pageCount))
-    }
+static parser_error_t parser_readUInt256Field(const parser_context_t *ctx, uint8_t fieldIdx, uint256_t *value) {
+    const parser_tx_t *v = ctx->tx_obj;
+    return rlp_readUInt256(ctx->buffer, v->nodes + v->rootFieldsIdx + fieldIdx, value);
+}
+
+static parser_error_t parser_parseBatchItem(parser_context_t *ctx,
+                                            const uint8_t *data, uint16_t dataLen,
+                                            parser_tx_t *tx_obj,
+                                            parser_batch_t *out, uint32_t i) {
+    // every tx starts from a fresh index, whatever tx_obj held before
+    CHECK_PARSER_ERR(parser_parse(ctx, data, dataLen, tx_obj))
+    CHECK_PARSER_ERR(parser_validate(ctx))
+
+    if (out->txType != NULL)
+        out->txType[i] = tx_obj->extraTxType;
+    if (out->nonce != NULL)
+        CHECK_PARSER_ERR(parser_readUInt64Field(ctx, MANTX_FIELD_NONCE, out->nonce + i))
+    if (out->gasPrice != NULL)
+        CHECK_PARSER_ERR(parser_readUInt256Field(ctx, MANTX_FIELD_GASPRICE, out->gasPrice + i))
+    if (out->gasLimit != NULL)
+        CHECK_PARSER_ERR(parser_readUInt64Field(ctx, MANTX_FIELD_GASLIMIT, out->gasLimit + i))
+    if (out->value != NULL)
+        CHECK_PARSER_ERR(parser_readUInt256Field(ctx, MANTX_FIELD_VALUE, out->value + i))
+    if (out->extraToCount != NULL)
+        out->extraToCount[i] = tx_obj->extraToListCount;
 
     return parser_ok;
 }
 
-uint8_t parser_getNumItems(const parser_context_t *ctx) {
-    return _getNumItems(ctx, &parser_tx_obj);
+uint32_t parser_parseBatch(const uint8_t *const *txs,
+                           const uint16_t *txLens,
+                           uint32_t first,
+                           uint32_t count,
+                           parser_tx_t *tx_obj,
+                           parser_batch_t *out) {
+    parser_context_t ctx;
+    uint32_t validCount = 0;
+
+    for (uint32_t i = first; i < first + count; i++) {
+        parser_error_t err = parser_parseBatchItem(&ctx, txs[i], txLens[i], tx_obj, out, i);
+        if (out->error != NULL)
+            out->error[i] = err;
+        if (err == parser_ok)
+            validCount++;
+    }
+
+    return validCount;
+}
+
+uint16_t parser_getNumItems(const parser_context_t *ctx) {
+    if (ctx->tx_obj == NULL) {
+        return 0;
+    }
+    return _getNumItems(ctx, ctx->tx_obj);
 }
 
 const uint8_t displayItemFieldIdxs[] = {
@@ -75,85 +148,121 @@ const uint8_t displayItemFieldIdxs[] = {
         MANTX_FIELD_EXTRA_LOCKHEIGHT,
 };
 
+// Prints a uint64 in decimal. Only the digits and the terminator are written, the rest of out is left as is
+static int8_t mantx_printUInt64(uint64_t value, char *out, uint16_t outLen) {
+    char digits[20];
+    uint8_t pos = sizeof(digits);
+    do {
+        digits[--pos] = (char) ('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    const uint8_t len = sizeof(digits) - pos;
+    if (outLen == 0 || len > outLen - 1)
+        return RLP_ERROR_BUFFER_TOO_SMALL;
+
+    MEMCPY(out, digits + pos, len);
+    out[len] = 0;
+    return RLP_NO_ERROR;
+}
+
+// Prints a uint256 in decimal. Values that fit in 64 bits skip the uint256 arithmetic
+static int8_t mantx_printUInt256(uint256_t *value, char *out, uint16_t outLen) {
+    if (bits256(value) <= 64)
+        return mantx_printUInt64(LOWER(LOWER_P(value)), out, outLen);
+
+    if (!tostring256(value, 10, out, outLen))
+        return RLP_ERROR_BUFFER_TOO_SMALL;
+    return RLP_NO_ERROR;
+}
+
+// Prints an unsigned field in decimal
+static int8_t mantx_printUInt(const uint8_t *data, const rlp_field_t *f, char *out, uint16_t outLen) {
+    uint64_t value;
+    int8_t err = rlp_readUInt64(data, f, &value);
+    if (err == RLP_NO_ERROR)
+        return mantx_printUInt64(value, out, outLen);
+    if (err != RLP_ERROR_OVERFLOW)
+        return err;
+
+    uint256_t tmp;
+    err = rlp_readUInt256(data, f, &tmp);
+    if (err != RLP_NO_ERROR)
+        return err;
+    return mantx_printUInt256(&tmp, out, outLen);
+}
+
+// Pages through the geometry computed at parse time when it was computed for this output size
+static int8_t mantx_printPage(const parser_tx_t *v,
+                              const uint8_t *data, const rlp_field_t *f,
+                              const rlp_paging_t *paging, uint8_t hex,
+                              char *out, uint16_t outLen,
+                              uint8_t pageIdx, uint8_t *pageCount) {
+    uint16_t valueLen;
+    if (paging->pageLen == 0 || outLen != v->pageWidth) {
+        if (hex)
+            return rlp_readHexPaging(data, f, out, outLen, &valueLen, pageIdx, pageCount);
+        return rlp_readStringPaging(data, f, out, outLen, &valueLen, pageIdx, pageCount);
+    }
+
+    *pageCount = paging->pageCount;
+    return rlp_readPage(data, f, paging, out, &valueLen, pageIdx);
+}
+
 int8_t mantx_print(parser_tx_t *v,
                    const uint8_t *data,
                    int8_t fieldIdx,
                    char *out, uint16_t outLen,
                    uint8_t pageIdx, uint8_t *pageCount) {
-    MEMSET(out, 0, outLen);
-    uint256_t tmp;
-    uint8_t err = RLP_NO_ERROR;
+    // every item terminates its own output
+    out[0] = 0;
+    int8_t err = RLP_NO_ERROR;
 
     *pageCount = 1;
 
     switch (fieldIdx) {
         case MANTX_FIELD_NONCE: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            err = rlp_readUInt256(data, f, &tmp);
-            if (err == RLP_NO_ERROR) {
-                if (!tostring256(&tmp, 10, out, outLen)) {
-                    err = parser_unexpected_field;
-                }
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            err = mantx_printUInt(data, f, out, outLen);
+            if (err == RLP_ERROR_BUFFER_TOO_SMALL) {
+                err = parser_unexpected_field;
             }
             break;
         }
         case MANTX_FIELD_GASPRICE: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            err = rlp_readUInt256(data, f, &tmp);
-            if (err == RLP_NO_ERROR) {
-                tostring256(&tmp, 10, out, outLen);
-            }
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            err = mantx_printUInt(data, f, out, outLen);
             break;
         }
         case MANTX_FIELD_GASLIMIT: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            err = rlp_readUInt256(data, f, &tmp);
-            if (err == RLP_NO_ERROR) {
-                tostring256(&tmp, 10, out, outLen);
-            }
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            err = mantx_printUInt(data, f, out, outLen);
             break;
         }
         case MANTX_FIELD_TO: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            uint16_t valueLen;
-            err = rlp_readStringPaging(
-                    data, f,
-                    (char *) out, outLen, &valueLen,
-                    pageIdx, pageCount);
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            err = mantx_printPage(v, data, f, &v->toPaging, 0,
+                                  out, outLen, pageIdx, pageCount);
             break;
         }
         case MANTX_FIELD_VALUE: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            err = rlp_readUInt256(data, f, &tmp);
-            if (err == RLP_NO_ERROR) {
-                tostring256(&tmp, 10, out, outLen);
-            }
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            err = mantx_printUInt(data, f, out, outLen);
             break;
         }
         case MANTX_FIELD_DATA: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            uint16_t valueLen;
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
 
             switch (v->extraTxType) {
                 case MANTX_TXTYPE_NORMAL:
                 case MANTX_TXTYPE_SCHEDULED: {
                     // ---------------- Optional DATA FIELD. Show hex if there is data
-                    err = rlp_readStringPaging(data, f,
-                                               (char *) out,
-                                               (outLen - 1) / 2,  // 2bytes per byte + zero termination
-                                               &valueLen,
-                                               pageIdx, pageCount);
-                    //snprintf(out, outLen, "%d - err %d", valueLen, err);
-                    if (err == RLP_NO_ERROR) {
-                        if (valueLen > 0) {
-                            // now we need to convert to hexstring in place
-                            convertToHexstringInPlace((uint8_t *) out, valueLen, outLen);
-                        } else {
-                            *pageCount = 0;
-                            err = RLP_NO_ERROR;
-                            break;
-                        }
+                    if (f->kind == RLP_KIND_STRING && f->valueLen == 0) {
+                        *pageCount = 0;
+                        break;
                     }
+                    err = mantx_printPage(v, data, f, &v->dataPaging, 1,
+                                          out, outLen, pageIdx, pageCount);
                     break;
                 }
 
@@ -161,23 +270,18 @@ int8_t mantx_print(parser_tx_t *v,
                 case MANTX_TXTYPE_CREATE_CURR:
                 case MANTX_TXTYPE_CANCEL_AUTH:
                     // ---------------- JSON Payload
-                    err = rlp_readStringPaging(data, f,
-                                               (char *) out, outLen,
-                                               &valueLen,
-                                               pageIdx, pageCount);
+                    if (v->JsonCount > 0) {
+                        // each member is shown as its own item
+                        *pageCount = 0;
+                        break;
+                    }
+                    err = mantx_printPage(v, data, f, &v->dataPaging, 0,
+                                          out, outLen, pageIdx, pageCount);
                     break;
                 case MANTX_TXTYPE_REVERT: {
                     // ----------------- HEX payload
-                    err = rlp_readStringPaging(data, f,
-                                               (char *) out,
-                                               (outLen - 1) / 2,  // 2bytes per byte + zero termination
-                                               &valueLen,
-                                               pageIdx, pageCount);
-                    //snprintf(out, outLen, "%d - err %d", valueLen, err);
-                    if (err == RLP_NO_ERROR) {
-                        // now we need to convert to hexstring in place
-                        convertToHexstringInPlace((uint8_t *) out, valueLen, outLen);
-                    }
+                    err = mantx_printPage(v, data, f, &v->dataPaging, 1,
+                                          out, outLen, pageIdx, pageCount);
                     break;
                 }
                 case MANTX_TXTYPE_BROADCAST:
@@ -197,11 +301,15 @@ int8_t mantx_print(parser_tx_t *v,
             break;
         }
         case MANTX_FIELD_V: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            uint8_t tmpByte;
-            err = rlp_readByte(data, f, &tmpByte);
+            // canonical RLP writes 0 as an empty string and 0x80 and above as a string of one byte
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            uint64_t chainId;
+            err = rlp_readUInt64(data, f, &chainId);
+            if (err == RLP_ERROR_OVERFLOW || (err == RLP_NO_ERROR && chainId > UINT8_MAX)) {
+                err = RLP_ERROR_INVALID_VALUE_LEN;
+            }
             if (err == RLP_NO_ERROR) {
-                snprintf(out, outLen, "%d", tmpByte);
+                snprintf(out, outLen, "%d", (uint8_t) chainId);
             }
             break;
         }
@@ -214,34 +322,23 @@ int8_t mantx_print(parser_tx_t *v,
             *pageCount = 0;
             break;
         case MANTX_FIELD_ENTERTYPE: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            err = rlp_readUInt256(data, f, &tmp);
-            if (err == RLP_NO_ERROR) {
-                tostring256(&tmp, 10, out, outLen);
-            }
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            err = mantx_printUInt(data, f, out, outLen);
             break;
         }
         case MANTX_FIELD_ISENTRUSTTX: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            err = rlp_readUInt256(data, f, &tmp);
-            if (err == RLP_NO_ERROR) {
-                tostring256(&tmp, 10, out, outLen);
-            }
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            err = mantx_printUInt(data, f, out, outLen);
             break;
         }
         case MANTX_FIELD_COMMITTIME: {
-            const rlp_field_t *f = v->rootFields + fieldIdx;
-            err = rlp_readUInt256(data, f, &tmp);
-            if (err == RLP_NO_ERROR) {
-                // this should be limited to uint64_t
-                if (tmp.elements[0].elements[0] != 0 ||
-                    tmp.elements[0].elements[1] != 0 ||
-                    tmp.elements[1].elements[0] != 0) {
-                    err = parser_invalid_time;
-                } else {
-                    uint64_t t = tmp.elements[1].elements[1];
-                    printTime(out, outLen, t);
-                }
+            const rlp_field_t *f = v->nodes + v->rootFieldsIdx + fieldIdx;
+            uint64_t t;
+            err = rlp_readUInt64(data, f, &t);
+            if (err == RLP_ERROR_OVERFLOW) {
+                err = parser_invalid_time;
+            } else if (err == RLP_NO_ERROR) {
+                printTime(out, outLen, t);
             }
             break;
         }
@@ -256,11 +353,8 @@ int8_t mantx_print(parser_tx_t *v,
             break;
         }
         case MANTX_FIELD_EXTRA_LOCKHEIGHT: {
-            const rlp_field_t *f = v->extraFields + 1;
-            err = rlp_readUInt256(data, f, &tmp);
-            if (err == RLP_NO_ERROR) {
-                tostring256(&tmp, 10, out, outLen);
-            }
+            const rlp_field_t *f = v->nodes + v->extraFieldsIdx + 1;
+            err = mantx_printUInt(data, f, out, outLen);
             break;
         }
         default:
@@ -274,13 +368,11 @@ int8_t mantx_print(parser_tx_t *v,
     return err;
 }
 
-parser_error_t parser_getItem(const parser_context_t *ctx,
-                              int8_t displayIdx,
+parser_error_t parser_getItem(parser_context_t *ctx,
+                              int16_t displayIdx,
                               char *outKey, uint16_t outKeyLen,
                               char *outVal, uint16_t outValLen,
                               uint8_t pageIdx, uint8_t *pageCount) {
-    MEMZERO(outKey, outKeyLen);
-    MEMZERO(outVal, outValLen);
     snprintf(outKey, outKeyLen, "?");
     snprintf(outVal, outValLen, " ");
 
@@ -288,6 +380,26 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
         return parser_no_data;
     }
 
+    if (displayIdx < MANTX_SUMMARY_COUNT) {
+        // Summary computed by parser_read
+        uint256_t *value;
+        if (displayIdx == 0) {
+            snprintf(outKey, outKeyLen, "Max Fee");
+            value = &ctx->tx_obj->maxFee;
+        } else {
+            snprintf(outKey, outKeyLen, "Total Out");
+            value = &ctx->tx_obj->totalOut;
+        }
+
+        *pageCount = 1;
+        int8_t err = mantx_printUInt256(value, outVal, outValLen);
+        if (err != RLP_NO_ERROR) {
+            snprintf(outVal, outValLen, "err %d", err);
+        }
+        return err;
+    }
+
+    displayIdx -= MANTX_SUMMARY_COUNT;
     if (displayIdx < MANTX_DISPLAY_COUNT) {
         snprintf(outVal, outValLen, " ");
 
@@ -334,26 +446,58 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
                 snprintf(outKey, outKeyLen, "?");
         }
 
-        int8_t err = mantx_print(&parser_tx_obj, ctx->buffer, fieldIdx,
+        int8_t err = mantx_print(ctx->tx_obj, ctx->buffer, fieldIdx,
                                  outVal, outValLen,
                                  pageIdx, pageCount);
 
         return err;
     }
 
-    if (displayIdx < MANTX_DISPLAY_COUNT + parser_tx_obj.extraToListCount * 3) {
-        uint8_t extraToIdx = (displayIdx - MANTX_DISPLAY_COUNT) / 3;
-        uint8_t fieldIdx = (displayIdx - MANTX_DISPLAY_COUNT) % 3;
+    displayIdx -= MANTX_DISPLAY_COUNT;
+    if (displayIdx < ctx->tx_obj->JsonCount) {
+        // Members of the JSON payload: the value is shown as text
+        json_span_t key;
+        json_span_t value;
+        CHECK_PARSER_ERR(parser_getJsonMember(ctx, ctx->tx_obj, displayIdx, &key, &value))
 
-        // Read the stream of three items
-        const rlp_field_t *f = &parser_tx_obj.extraToListFields[extraToIdx];
-        rlp_field_t extraToFields[3];
-        uint16_t fieldCount;
-        int8_t err = rlp_readList(ctx->buffer, f, extraToFields, MANTX_ROOTFIELD_COUNT, &fieldCount);
-        if (err != parser_ok)
-            return err;
-        if (fieldCount != 3)
-            return parser_unexpected_field_count;
+        // keys come from the payload, so they always get a prefix that no tx field has
+        snprintf(outKey, outKeyLen, "Data.");
+        const uint16_t prefixLen = strlen(outKey);
+        uint16_t keyLen = key.len;
+        if (keyLen > outKeyLen - 1 - prefixLen) {
+            keyLen = outKeyLen - 1 - prefixLen;
+        }
+        MEMCPY(outKey + prefixLen, ctx->buffer + key.offset, keyLen);
+        outKey[prefixLen + keyLen] = 0;
+
+        if (value.len == 0) {
+            // an empty value would have no pages at all
+            if (pageIdx > 0)
+                return parser_display_page_out_of_range;
+            snprintf(outVal, outValLen, "(empty)");
+            *pageCount = 1;
+            return parser_ok;
+        }
+
+        // pages of the value are the pages of a string field that only holds it
+        rlp_field_t f;
+        f.kind = RLP_KIND_STRING;
+        f.fieldOffset = value.offset;
+        f.valueOffset = 0;
+        f.valueLen = value.len;
+        uint16_t valueLen;
+        return rlp_readStringPaging(ctx->buffer, &f, outVal, outValLen, &valueLen, pageIdx, pageCount);
+    }
+
+    displayIdx -= ctx->tx_obj->JsonCount;
+    if (displayIdx < ctx->tx_obj->extraToListCount * 3) {
+        uint16_t extraToIdx = displayIdx / 3;
+        uint8_t fieldIdx = displayIdx % 3;
+
+        // The three items (recipient, amount, payload) are located on demand
+        rlp_field_t extraToFields[MANTX_EXTRATOFIELD_COUNT];
+        CHECK_PARSER_ERR(parser_getExtraTo(ctx, ctx->tx_obj, extraToIdx, extraToFields))
+        int8_t err = parser_ok;
 
         uint16_t valueLen;
         switch (fieldIdx) {
@@ -366,26 +510,16 @@ parser_error_t parser_getItem(const parser_context_t *ctx,
                 break;
             }
             case 1: {
-                uint256_t tmp;
                 snprintf(outKey, outKeyLen, "[%d] Amount", extraToIdx);
-                rlp_readUInt256(ctx->buffer, extraToFields + 1, &tmp);
-                tostring256(&tmp, 10, outVal, outValLen);
+                err = mantx_printUInt(ctx->buffer, extraToFields + 1, outVal, outValLen);
                 break;
             }
             case 2: {
                 snprintf(outKey, outKeyLen, "[%d] Payload", extraToIdx);
                 // ----------------- HEX payload
-                err = rlp_readStringPaging(ctx->buffer,
-                                           extraToFields + 2,
-                                           (char *) outVal,
-                                           (outValLen - 1) / 2,  // 2bytes per byte + zero termination
-                                           &valueLen,
-                                           pageIdx, pageCount);
-                //snprintf(out, outLen, "%d - err %d", valueLen, err);
-                if (err == RLP_NO_ERROR) {
-                    // now we need to convert to hexstring in place
-                    convertToHexstringInPlace((uint8_t *) outVal, valueLen, outValLen);
-                }
+                err = rlp_readHexPaging(ctx->buffer, extraToFields + 2,
+                                        outVal, outValLen, &valueLen,
+                                        pageIdx, pageCount);
                 break;
             }
         }
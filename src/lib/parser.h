@@ -25,20 +25,63 @@ extern "C" {
 
 const char *parser_getErrorDescription(parser_error_t err);
 
-//// parses a tx buffer
+//// starts parsing a tx buffer that will be received in chunks
+void parser_parseStart(parser_tx_t *tx_obj);
+
+//// parses the part of the tx buffer received so far, after parser_parseStart
+//// structural errors are reported as soon as the offending bytes arrive
+parser_error_t parser_parseChunk(parser_context_t *ctx,
+                                 const uint8_t *data,
+                                 uint16_t dataLen,
+                                 parser_tx_t *tx_obj);
+
+//// parses the whole tx buffer, finishing the work started by parser_parseStart / parser_parseChunk
+parser_error_t parser_parseFinish(parser_context_t *ctx,
+                                  const uint8_t *data,
+                                  uint16_t dataLen,
+                                  parser_tx_t *tx_obj);
+
+//// parses a tx buffer from scratch. tx_obj does not need to be initialized
+//// the parsed state is kept in tx_obj, which must outlive ctx
 parser_error_t parser_parse(parser_context_t *ctx,
                             const uint8_t *data,
-                            uint16_t dataLen);
+                            uint16_t dataLen,
+                            parser_tx_t *tx_obj);
 
 //// verifies tx fields
 parser_error_t parser_validate(const parser_context_t *ctx);
 
+//// batch results, one entry per tx in parallel arrays
+//// arrays left as NULL are not filled
+typedef struct {
+    uint8_t *txType;
+    uint64_t *nonce;
+    uint256_t *gasPrice;
+    uint64_t *gasLimit;
+    uint256_t *value;
+    uint16_t *extraToCount;
+    parser_error_t *error;
+} parser_batch_t;
+
+//// parses and validates txs[first .. first + count) and stores the results at the same indexes
+//// tx_obj is reused for every tx and does not need to be initialized
+//// disjoint ranges can be processed concurrently with one tx_obj each
+//// returns the number of valid txs in the range
+uint32_t parser_parseBatch(const uint8_t *const *txs,
+                           const uint16_t *txLens,
+                           uint32_t first,
+                           uint32_t count,
+                           parser_tx_t *tx_obj,
+                           parser_batch_t *out);
+
 //// returns the number of items in the current parsing context
-uint8_t parser_getNumItems(const parser_context_t *ctx);
+uint16_t parser_getNumItems(const parser_context_t *ctx);
 
 // retrieves a readable output for each field / page
-parser_error_t parser_getItem(const parser_context_t *ctx,
-                              int8_t displayIdx,
+// Lookups of extraTo entries and JSON members move cursors kept in ctx->tx_obj, so a parsed tx
+// must not be rendered from more than one thread at a time
+parser_error_t parser_getItem(parser_context_t *ctx,
+                              int16_t displayIdx,
                               char *outKey, uint16_t outKeyLen,
                               char *outValue, uint16_t outValueLen,
                               uint8_t pageIdx, uint8_t *pageCount);
@@ -21,6 +21,12 @@ extern "C" {
 
 #include <stdint.h>
 #include <stddef.h>
+#include "parser_txdef.h"
+
+// the SDK provides UNUSED on the device
+#ifndef UNUSED
+#define UNUSED(x) (void)(x)
+#endif
 
 #define CHECK_PARSER_ERR(CALL) { \
     parser_error_t err = CALL;  \
@@ -41,6 +47,7 @@ typedef enum {
     parser_invalid_time,
     parser_invalid_tx_type,
     parser_extrato_too_many,
+    parser_value_overflow,
     // Context related errors
     parser_context_mismatch,
     parser_context_unexpected_size,
@@ -55,6 +62,8 @@ typedef struct {
     const uint8_t *buffer;
     uint16_t bufferLen;
     uint16_t offset;
+    // parsed tx state, owned by the caller
+    parser_tx_t *tx_obj;
 } parser_context_t;
 
 #ifdef __cplusplus
@@ -16,8 +16,7 @@
 
 #include <zxmacros.h>
 #include "parser_impl.h"
-
-parser_tx_t parser_tx_obj;
+#include "json.h"
 
 parser_error_t parser_init_context(parser_context_t *ctx,
                                    const uint8_t *buffer,
@@ -96,56 +95,293 @@ parser_error_t getDisplayTxExtraType(char *out, uint16_t outLen, uint8_t txtype)
     return parser_ok;
 }
 
-parser_error_t parser_read(parser_context_t *ctx, parser_tx_t *v) {
-    uint16_t fieldCount;
+void parser_readStart(parser_tx_t *v) {
+    rlp_indexerInit(&v->indexer, v->nodes, MANTX_NODE_COUNT, MANTX_NODE_DEPTH);
+}
 
-    // we expect a single root list
-    int8_t err = rlp_parseStream(ctx->buffer, 0, ctx->bufferLen, &v->root, 1, &fieldCount);
-    if (err != parser_ok)
-        return err;
-    if (v->root.kind != RLP_KIND_LIST)
-        return parser_unexpected_root;
+parser_error_t parser_readChunk(parser_context_t *ctx, parser_tx_t *v) {
+    // index whatever has arrived so far
+    int8_t err = rlp_indexerFeed(&v->indexer, ctx->buffer, ctx->bufferLen);
+    if (err == RLP_ERROR_BUFFER_TOO_SMALL)
+        return parser_unexpected_field_count;
+    return err;
+}
 
-    // now we can extract all rootFields in that list
-    err = rlp_readList(ctx->buffer, &v->root, v->rootFields, MANTX_ROOTFIELD_COUNT, &fieldCount);
-    if (err != parser_ok)
+// Reads the fields of the next extraTo entry in the list
+static parser_error_t parser_readExtraToEntry(rlp_iter_t *list, rlp_field_t *fields) {
+    rlp_iter_t entry;
+    int8_t err = rlp_iterNextList(list, &entry);
+    if (err != RLP_NO_ERROR)
         return err;
-    if (fieldCount != MANTX_ROOTFIELD_COUNT)
+
+    // Each extraTo item is a list of 3 elements (recipient, amount, payload)
+    for (uint8_t i = 0; i < MANTX_EXTRATOFIELD_COUNT; i++) {
+        if (rlp_iterDone(&entry))
+            return parser_unexpected_field_count;
+        err = rlp_iterNext(&entry, fields + i);
+        if (err != RLP_NO_ERROR)
+            return err;
+    }
+    if (!rlp_iterDone(&entry))
         return parser_unexpected_field_count;
 
-    ////////// EXTRA
-    // Now parse the extra field
-    const rlp_field_t *extraField = &v->rootFields[MANTX_FIELD_EXTRA];
-    rlp_field_t extraFieldInternal;
-    err = rlp_readList(ctx->buffer,
-                       extraField,
-                       &extraFieldInternal,
-                       1, &fieldCount);
-    if (err != parser_ok)
+    return parser_ok;
+}
+
+// Adds the amount in field to total. Sums that do not fit in 256 bits cannot be paid
+static parser_error_t parser_addAmount(const uint8_t *data, const rlp_field_t *field, uint256_t *total) {
+    uint256_t amount;
+    int8_t err = rlp_readUInt256(data, field, &amount);
+    if (err != RLP_NO_ERROR)
         return err;
-    if (fieldCount != 1)
-        return parser_unexpected_field_count;
-    if (extraFieldInternal.kind != RLP_KIND_LIST)
-        return parser_unexpected_field_type;
 
-    // Now parse the extraInternal field
-    err = rlp_readList(ctx->buffer,
-                       &extraFieldInternal,
-                       v->extraFields,
-                       MANTX_EXTRAFIELD_COUNT, &fieldCount);
+    add256(total, &amount, total);
+    if (gt256(&amount, total))
+        return parser_value_overflow;
+    return parser_ok;
+}
+
+// Walks the extraTo entries once to check them, keeping evenly spaced checkpoints
+// The amounts are added to totalOut
+static parser_error_t parser_readExtraTo(const parser_context_t *ctx, parser_tx_t *v) {
+    rlp_field_t fields[MANTX_EXTRATOFIELD_COUNT];
+    rlp_iter_t list;
+
+    v->extraToListCount = 0;
+    v->extraToStride = 1;
+
+    int8_t err = rlp_iterInit(&list, ctx->buffer, v->nodes + v->extraToListIdx);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    v->extraToCursorIdx = 0;
+    v->extraToCursorOffset = list.offset;
+
+    while (!rlp_iterDone(&list)) {
+        if (v->extraToListCount >= MANTX_EXTRATO_MAX_COUNT)
+            return parser_extrato_too_many;
+
+        if (v->extraToListCount % v->extraToStride == 0) {
+            if (v->extraToListCount / v->extraToStride == MANTX_EXTRATO_CHECKPOINT_COUNT) {
+                // out of checkpoints: keep every other one
+                for (uint8_t i = 0; i < MANTX_EXTRATO_CHECKPOINT_COUNT / 2; i++) {
+                    v->extraToCheckpoints[i] = v->extraToCheckpoints[2 * i];
+                }
+                v->extraToStride *= 2;
+            }
+            if (v->extraToListCount % v->extraToStride == 0) {
+                v->extraToCheckpoints[v->extraToListCount / v->extraToStride] = list.offset;
+            }
+        }
+
+        CHECK_PARSER_ERR(parser_readExtraToEntry(&list, fields))
+        CHECK_PARSER_ERR(parser_addAmount(ctx->buffer, fields + 1, &v->totalOut))
+        v->extraToListCount++;
+    }
+
+    return parser_ok;
+}
+
+parser_error_t parser_getExtraTo(const parser_context_t *ctx, parser_tx_t *v, uint16_t idx, rlp_field_t *fields) {
+    if (idx >= v->extraToListCount)
+        return parser_display_idx_out_of_range;
+
+    rlp_iter_t list;
+    int8_t err = rlp_iterInit(&list, ctx->buffer, v->nodes + v->extraToListIdx);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    // start from the closest checkpoint, or from the last entry if it is closer
+    uint16_t entryIdx = idx - idx % v->extraToStride;
+    list.offset = v->extraToCheckpoints[idx / v->extraToStride];
+    if (v->extraToCursorIdx <= idx && v->extraToCursorIdx > entryIdx) {
+        entryIdx = v->extraToCursorIdx;
+        list.offset = v->extraToCursorOffset;
+    }
+
+    rlp_field_t entry;
+    while (entryIdx < idx) {
+        err = rlp_iterNext(&list, &entry);
+        if (err != RLP_NO_ERROR)
+            return err;
+        entryIdx++;
+    }
+
+    v->extraToCursorIdx = idx;
+    v->extraToCursorOffset = list.offset;
+
+    return parser_readExtraToEntry(&list, fields);
+}
+
+// Computes the summary items: gasPrice * gasLimit and value + extraTo amounts (the latter are already in totalOut)
+static parser_error_t parser_readSummary(const parser_context_t *ctx, parser_tx_t *v) {
+    const rlp_field_t *root = v->nodes + v->rootFieldsIdx;
+    uint256_t gasPrice;
+    uint256_t gasLimit;
+    int8_t err;
+
+    if ((err = rlp_readUInt256(ctx->buffer, root + MANTX_FIELD_GASPRICE, &gasPrice)) != RLP_NO_ERROR)
+        return err;
+    if ((err = rlp_readUInt256(ctx->buffer, root + MANTX_FIELD_GASLIMIT, &gasLimit)) != RLP_NO_ERROR)
+        return err;
 
-    if (err != parser_ok) {
+    // a product of a bits and b bits takes a + b - 1 or a + b bits
+    const uint32_t bits = bits256(&gasPrice) + bits256(&gasLimit);
+    if (bits > 257)
+        return parser_value_overflow;
+    mul256(&gasPrice, &gasLimit, &v->maxFee);
+    if (bits == 257) {
+        // only the product itself tells
+        uint256_t q;
+        uint256_t r;
+        divmod256(&v->maxFee, &gasPrice, &q, &r);
+        if (!equal256(&q, &gasLimit) || !zero256(&r))
+            return parser_value_overflow;
+    }
+
+    return parser_addAmount(ctx->buffer, root + MANTX_FIELD_VALUE, &v->totalOut);
+}
+
+// DATA is shown as hex for every tx type but the ones with a JSON payload
+static uint8_t parser_isHexData(uint8_t txType) {
+    switch (txType) {
+        case MANTX_TXTYPE_AUTHORIZED:
+        case MANTX_TXTYPE_CREATE_CURR:
+        case MANTX_TXTYPE_CANCEL_AUTH:
+            // JSON payload
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+// Page flips then only slice the value. Fields that cannot be paged make the tx invalid
+static int8_t parser_readPaging(parser_tx_t *v) {
+    const rlp_field_t *root = v->nodes + v->rootFieldsIdx;
+
+    v->toPaging.pageLen = 0;
+    v->dataPaging.pageLen = 0;
+    if (v->pageWidth == 0)
+        return RLP_NO_ERROR;
+
+    int8_t err = rlp_pagingInit(&v->toPaging, root + MANTX_FIELD_TO, v->pageWidth, 0);
+    if (err != RLP_NO_ERROR) {
+        v->toPaging.pageLen = 0;
+        return err;
+    }
+    err = rlp_pagingInit(&v->dataPaging, root + MANTX_FIELD_DATA, v->pageWidth,
+                         parser_isHexData(v->extraTxType));
+    if (err != RLP_NO_ERROR) {
+        v->dataPaging.pageLen = 0;
         return err;
     }
-    if (fieldCount != MANTX_EXTRAFIELD_COUNT)
+    return RLP_NO_ERROR;
+}
+
+static int8_t parser_jsonInit(const parser_context_t *ctx, const parser_tx_t *v, json_iter_t *iter) {
+    const rlp_field_t *f = v->nodes + v->rootFieldsIdx + MANTX_FIELD_DATA;
+    uint16_t len;
+    if (rlp_readBytesLen(f, &len) != RLP_NO_ERROR)
+        return JSON_ERROR_SYNTAX;
+    return json_objectInit(iter, ctx->buffer, f->fieldOffset + f->valueOffset, len);
+}
+
+// Counts the members of a JSON payload. Payloads that are not a flat enough object are shown as raw text
+static void parser_readJson(const parser_context_t *ctx, parser_tx_t *v) {
+    json_iter_t iter;
+    json_span_t key;
+    json_span_t value;
+
+    v->JsonCount = 0;
+    if (parser_isHexData(v->extraTxType))
+        return;
+
+    if (parser_jsonInit(ctx, v, &iter) != JSON_NO_ERROR)
+        return;
+
+    uint8_t count = 0;
+    int8_t err;
+    while ((err = json_objectNext(&iter, &key, &value)) == JSON_NO_ERROR) {
+        if (count == MANTX_JSON_MAX_COUNT)
+            return;
+        count++;
+    }
+    if (err != JSON_ERROR_NO_MORE_ITEMS || json_objectFinish(&iter) != JSON_NO_ERROR)
+        return;
+
+    v->JsonCount = count;
+    v->jsonCursorIdx = 0;
+    v->jsonCursorOffset = 0;
+}
+
+parser_error_t parser_getJsonMember(const parser_context_t *ctx, parser_tx_t *v, uint8_t idx,
+                                    json_span_t *key, json_span_t *value) {
+    if (idx >= v->JsonCount)
+        return parser_display_idx_out_of_range;
+
+    json_iter_t iter;
+    if (parser_jsonInit(ctx, v, &iter) != JSON_NO_ERROR)
+        return parser_unexpected_field;
+
+    // resume after the last member that was looked up, if it comes before
+    uint8_t memberIdx = 0;
+    if (v->jsonCursorIdx > 0 && v->jsonCursorIdx <= idx) {
+        memberIdx = v->jsonCursorIdx;
+        iter.offset = v->jsonCursorOffset;
+        iter.first = 0;
+    }
+
+    for (; memberIdx <= idx; memberIdx++) {
+        if (json_objectNext(&iter, key, value) != JSON_NO_ERROR)
+            return parser_unexpected_field;
+    }
+
+    v->jsonCursorIdx = idx + 1;
+    v->jsonCursorOffset = iter.offset;
+
+    return parser_ok;
+}
+
+parser_error_t parser_read(parser_context_t *ctx, parser_tx_t *v) {
+    // finish the index started by parser_readStart, which may already cover some chunks
+    // Every later lookup is an arena index
+    int8_t err = parser_readChunk(ctx, v);
+    if (err != parser_ok)
+        return err;
+    err = rlp_indexerFinish(&v->indexer, ctx->bufferLen);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    // we expect a single root list
+    const rlp_field_t *root = v->nodes;
+    if (root->kind != RLP_KIND_LIST)
+        return parser_unexpected_root;
+    if (root->childCount != MANTX_ROOTFIELD_COUNT)
+        return parser_unexpected_field_count;
+    v->rootFieldsIdx = root->firstChild;
+
+    ////////// EXTRA
+    const rlp_field_t *extraField = v->nodes + v->rootFieldsIdx + MANTX_FIELD_EXTRA;
+    if (extraField->kind != RLP_KIND_LIST)
+        return parser_unexpected_field_type;
+    if (extraField->childCount != 1)
         return parser_unexpected_field_count;
 
+    const rlp_field_t *extraFieldInternal = v->nodes + extraField->firstChild;
+    if (extraFieldInternal->kind != RLP_KIND_LIST)
+        return parser_unexpected_field_type;
+    if (extraFieldInternal->childCount != MANTX_EXTRAFIELD_COUNT)
+        return parser_unexpected_field_count;
+    v->extraFieldsIdx = extraFieldInternal->firstChild;
+
     // Extract extra txType and cache it as metadata
-    const rlp_field_t *f = v->extraFields;
-    uint256_t tmp;
-    err = rlp_readUInt256(ctx->buffer, f, &tmp);
+    const rlp_field_t *f = v->nodes + v->extraFieldsIdx;
+    uint64_t txType;
+    err = rlp_readUInt64(ctx->buffer, f, &txType);
+    if (err == RLP_ERROR_OVERFLOW || (err == RLP_NO_ERROR && txType > UINT8_MAX))
+        return parser_invalid_tx_type;
     if (err != RLP_NO_ERROR) { return err; }
-    v->extraTxType = tmp.elements[1].elements[1];   // extract last byte
+    v->extraTxType = (uint8_t) txType;
 
     // Validate txtype
     char tmpBuf[2] = {0, 0};
@@ -156,22 +392,101 @@ parser_error_t parser_read(parser_context_t *ctx, parser_tx_t *v) {
     //////////
     ////////// EXTRA TO
     //////////
-    f = v->extraFields + 2;
-    err = rlp_readList(ctx->buffer, f,
-                       v->extraToListFields,
-                       MANTX_EXTRALISTFIELD_COUNT,
-                       &v->extraToListCount);
-    if (err != parser_ok)
-        return err;
-    // Get each extraTo item is a stream of 3 elements (recipient, amount, payload)
-    // To avoid using too much memory, we can parse them on demand
+    v->extraToListIdx = v->extraFieldsIdx + 2;
+    f = v->nodes + v->extraToListIdx;
+    if (f->kind != RLP_KIND_LIST)
+        return RLP_ERROR_INVALID_KIND;
+    clear256(&v->totalOut);
+    CHECK_PARSER_ERR(parser_readExtraTo(ctx, v))
 
-    v->JsonCount = 0;
+    CHECK_PARSER_ERR(parser_readSummary(ctx, v))
+
+    CHECK_PARSER_ERR(parser_readPaging(v))
+    parser_readJson(ctx, v);
 
     return parser_ok;
 }
 
+// Checks that a field can be read as an unsigned number of at most maxBytes significant bytes
+static int8_t _checkUInt(const uint8_t *data, const rlp_field_t *f, uint8_t maxBytes) {
+    if (f->kind == RLP_KIND_BYTE)
+        return RLP_NO_ERROR;
+    if (f->kind != RLP_KIND_STRING)
+        return RLP_ERROR_INVALID_KIND;
+    if (f->valueLen > 32)
+        return RLP_ERROR_INVALID_VALUE_LEN;
+
+    // leading zeros are accepted, as they are when the value is read
+    const uint8_t *p = data + f->fieldOffset + f->valueOffset;
+    for (uint16_t i = maxBytes; i < f->valueLen; i++) {
+        if (p[f->valueLen - 1 - i] != 0)
+            return RLP_ERROR_INVALID_VALUE_LEN;
+    }
+    return RLP_NO_ERROR;
+}
+
+// Single bytes below 0x80 are strings of one byte in canonical RLP
+static int8_t _checkString(const rlp_field_t *f) {
+    uint16_t len;
+    return rlp_readBytesLen(f, &len);
+}
+
+// Checks that a field shown page by page has a page count that the device can show
+static int8_t _checkPaging(const parser_tx_t *v, const rlp_field_t *f, uint8_t hex) {
+    if (v->pageWidth == 0)
+        return _checkString(f);
+    rlp_paging_t paging;
+    return rlp_pagingInit(&paging, f, v->pageWidth, hex);
+}
+
+// Runs the same kind, length, type and paging checks as rendering every item, without producing any text
+// JSON member values are shorter than DATA, so they can be paged whenever DATA can
 parser_error_t _validateTx(const parser_context_t *c, const parser_tx_t *v) {
+    const rlp_field_t *root = v->nodes + v->rootFieldsIdx;
+    int8_t err;
+
+    if (_checkUInt(c->buffer, root + MANTX_FIELD_NONCE, 8) != RLP_NO_ERROR)
+        return parser_unexpected_field;
+    if (_checkUInt(c->buffer, root + MANTX_FIELD_COMMITTIME, 8) != RLP_NO_ERROR)
+        return parser_invalid_time;
+
+    if ((err = _checkUInt(c->buffer, root + MANTX_FIELD_GASPRICE, 32)) != RLP_NO_ERROR)
+        return err;
+    if ((err = _checkUInt(c->buffer, root + MANTX_FIELD_GASLIMIT, 32)) != RLP_NO_ERROR)
+        return err;
+    if ((err = _checkPaging(v, root + MANTX_FIELD_TO, 0)) != RLP_NO_ERROR)
+        return err;
+    if ((err = _checkUInt(c->buffer, root + MANTX_FIELD_VALUE, 32)) != RLP_NO_ERROR)
+        return err;
+    if ((err = _checkPaging(v, root + MANTX_FIELD_DATA, parser_isHexData(v->extraTxType))) != RLP_NO_ERROR)
+        return err;
+    if ((err = _checkUInt(c->buffer, root + MANTX_FIELD_ENTERTYPE, 32)) != RLP_NO_ERROR)
+        return err;
+    if ((err = _checkUInt(c->buffer, root + MANTX_FIELD_ISENTRUSTTX, 32)) != RLP_NO_ERROR)
+        return err;
+
+    // ChainID is shown as a single byte
+    if ((err = _checkUInt(c->buffer, root + MANTX_FIELD_V, 1)) != RLP_NO_ERROR)
+        return err;
+
+    // The tx type was checked when parsing
+    if ((err = _checkUInt(c->buffer, v->nodes + v->extraFieldsIdx + 1, 32)) != RLP_NO_ERROR)
+        return err;
+
+    rlp_field_t extraToFields[MANTX_EXTRATOFIELD_COUNT];
+    rlp_iter_t list;
+    if ((err = rlp_iterInit(&list, c->buffer, v->nodes + v->extraToListIdx)) != RLP_NO_ERROR)
+        return err;
+    for (uint16_t i = 0; i < v->extraToListCount; i++) {
+        CHECK_PARSER_ERR(parser_readExtraToEntry(&list, extraToFields))
+        if ((err = _checkPaging(v, extraToFields + 0, 0)) != RLP_NO_ERROR)
+            return err;
+        if ((err = _checkUInt(c->buffer, extraToFields + 1, 32)) != RLP_NO_ERROR)
+            return err;
+        if ((err = _checkPaging(v, extraToFields + 2, 1)) != RLP_NO_ERROR)
+            return err;
+    }
+
     return parser_ok;
 }
 
@@ -198,9 +513,13 @@ const char *parser_getErrorDescription(parser_error_t err) {
         case parser_unexpected_field_type:
             return "Unexpected field type";
         case parser_invalid_time:
-            return "Unsupported TxType";
+            return "Invalid time";
         case parser_invalid_tx_type:
             return "Invalid tx type";
+        case parser_extrato_too_many:
+            return "Too many extraTo items";
+        case parser_value_overflow:
+            return "Value overflow";
             // Required fields error
         case parser_required_nonce:
             return "Required field nonce";
@@ -211,6 +530,7 @@ const char *parser_getErrorDescription(parser_error_t err) {
     }
 }
 
-uint8_t _getNumItems(const parser_context_t *c, const parser_tx_t *v) {
-    return MANTX_DISPLAY_COUNT + v->extraToListCount * 3 + v->JsonCount;
+uint16_t _getNumItems(const parser_context_t *c, const parser_tx_t *v) {
+    UNUSED(c);
+    return MANTX_SUMMARY_COUNT + MANTX_DISPLAY_COUNT + v->extraToListCount * 3 + v->JsonCount;
 }
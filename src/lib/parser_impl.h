@@ -17,22 +17,32 @@
 
 #include "parser_common.h"
 #include "parser_txdef.h"
+#include "json.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-extern parser_tx_t parser_tx_obj;
-
 parser_error_t parser_init(parser_context_t *ctx, const uint8_t *buffer, uint16_t bufferSize);
 
 parser_error_t getDisplayTxExtraType(char *out, uint16_t outLen, uint8_t txtype);
 
+void parser_readStart(parser_tx_t *v);
+
+parser_error_t parser_readChunk(parser_context_t *ctx, parser_tx_t *v);
+
 parser_error_t parser_read(parser_context_t *ctx, parser_tx_t *v);
 
+// reads the fields of extraTo entry idx, moving the cursor of v
+parser_error_t parser_getExtraTo(const parser_context_t *ctx, parser_tx_t *v, uint16_t idx, rlp_field_t *fields);
+
+// locates member idx of the JSON payload, moving the cursor of v
+parser_error_t parser_getJsonMember(const parser_context_t *ctx, parser_tx_t *v, uint8_t idx,
+                                    json_span_t *key, json_span_t *value);
+
 parser_error_t _validateTx(const parser_context_t *c, const parser_tx_t *v);
 
-uint8_t _getNumItems(const parser_context_t *c, const parser_tx_t *v);
+uint16_t _getNumItems(const parser_context_t *c, const parser_tx_t *v);
 
 #ifdef __cplusplus
 }
@@ -18,7 +18,6 @@
 #include <rlp.h>
 #include <coin.h>
 #include <zxtypes.h>
-#include "parser_common.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,7 +28,18 @@ extern "C" {
 
 #define MANTX_ROOTFIELD_COUNT 13
 #define MANTX_EXTRAFIELD_COUNT 3
-#define MANTX_EXTRALISTFIELD_COUNT 10
+#define MANTX_EXTRATOFIELD_COUNT 3
+
+// root + root fields + extra + extra fields. extraTo entries are not indexed, they are read on demand
+#define MANTX_NODE_DEPTH 3
+#define MANTX_NODE_COUNT (1 + MANTX_ROOTFIELD_COUNT + 1 + MANTX_EXTRAFIELD_COUNT)
+
+// keeps the display index space within int16_t
+#define MANTX_EXTRATO_MAX_COUNT 10000
+#define MANTX_EXTRATO_CHECKPOINT_COUNT 16
+
+// JSON payloads with more members are shown as raw text
+#define MANTX_JSON_MAX_COUNT 32
 
 /////////////// TX TYPES
 #define MANTX_TXTYPE_NORMAL             0
@@ -70,15 +80,38 @@ extern "C" {
 #define MANTX_FIELD_EXTRA_TO          15
 
 #define MANTX_DISPLAY_COUNT 12
+// Max Fee and Total Out, shown before every other item
+#define MANTX_SUMMARY_COUNT 2
 
 typedef struct {
-    rlp_field_t root;
-    rlp_field_t rootFields[MANTX_ROOTFIELD_COUNT];
-    rlp_field_t extraFields[MANTX_EXTRAFIELD_COUNT];
-    rlp_field_t extraToListFields[MANTX_EXTRALISTFIELD_COUNT];
+    // whole tx tree, indexed once (possibly while chunks arrive). nodes[0] is the root list
+    rlp_field_t nodes[MANTX_NODE_COUNT];
+    rlp_indexer_t indexer;
+    // arena indexes of the first element of each group
+    uint8_t rootFieldsIdx;
+    uint8_t extraFieldsIdx;
+    uint8_t extraToListIdx;     // the extraTo list itself
     uint8_t extraTxType;
     uint16_t extraToListCount;
+    // entry k * extraToStride starts at extraToCheckpoints[k]
+    uint16_t extraToStride;
+    uint16_t extraToCheckpoints[MANTX_EXTRATO_CHECKPOINT_COUNT];
+    // last entry that was looked up
+    uint16_t extraToCursorIdx;
+    uint16_t extraToCursorOffset;
+    // summary, computed once by parser_read
+    uint256_t maxFee;           // gasPrice * gasLimit
+    uint256_t totalOut;         // value + every extraTo amount
+    // page geometry of To and Data for values of pageWidth chars, computed once by parser_read
+    // a pageLen of 0 means that the geometry is computed on every render
+    uint16_t pageWidth;
+    rlp_paging_t toPaging;
+    rlp_paging_t dataPaging;
+    // members of the JSON payload, each one shown as an item. 0 if DATA is shown as it is
     uint8_t JsonCount;
+    // last member that was looked up, and the offset right after it
+    uint8_t jsonCursorIdx;
+    uint16_t jsonCursorOffset;
 } parser_tx_t;
 
 #ifdef __cplusplus
@@ -16,61 +16,90 @@
 
 #include "rlp.h"
 #include "utils/uint256.h"
-
-int16_t rlp_decode(
-    const uint8_t *data,
-    uint8_t *kind,
-    uint16_t *len,
-    uint16_t *valueOffset) {
-
-    uint8_t p = *data;
-    if (p >= 0 && p <= 0x7F) {
+#include "utils/utils.h"
+
+static int16_t rlp_decodePrefix(const uint8_t *data,
+                                const uint8_t *end,
+                                uint8_t *kind,
+                                uint16_t *len,
+                                uint16_t *valueOffset) {
+    if (data >= end)
+        return RLP_ERROR_TRUNCATED;
+
+    // Range comparisons in the order of the most frequent prefixes, they are as fast as a table on txs
+    const uint8_t p = *data;
+    if (p <= 0x7F) {
+        // single byte, it is its own value
         *kind = RLP_KIND_BYTE;
         *len = 0;
         *valueOffset = 0;
-        return 1; // 1 byte to consume from the stream
+        return 1;
     }
 
-    if (p >= 0x80 && p <= 0xb7) {
+    uint8_t lenLen;
+    if (p <= 0xB7) {
+        // string of up to 55 bytes
         *kind = RLP_KIND_STRING;
         *len = p - 0x80;
         *valueOffset = 1;
         return 1 + *len;
-    }
-
-    if (p >= 0xb8 && p <= 0xbf) {
+    } else if (p <= 0xBF) {
+        // longer string, followed by its length in 1-8 bytes
         *kind = RLP_KIND_STRING;
-        uint8_t len_len = p - 0xb7;
-        *len = 0;
-        for (uint8_t i = 0; i < len_len; i++) {
-            *len <<= 8u;
-            *len += *(data + 1 + i);
-        }
-        *valueOffset = 1 + len_len;
-        return 1 + len_len + *len;
-    }
-
-    if (p >= 0xc0 && p <= 0xf7) {
+        lenLen = p - 0xB7;
+    } else if (p <= 0xF7) {
+        // list of up to 55 bytes
         *kind = RLP_KIND_LIST;
-        *len = p - 0xc0;
+        *len = p - 0xC0;
         *valueOffset = 1;
         return 1 + *len;
+    } else {
+        // longer list, followed by its length in 1-8 bytes
+        *kind = RLP_KIND_LIST;
+        lenLen = p - 0xF7;
     }
 
-    if (p >= 0xf8 && p <= 0xff) {
-        *kind = RLP_KIND_LIST;
-        uint8_t len_len = p - 0xf7;
-        *len = p - 0xf7;
-        *len = 0;
-        for (uint8_t i = 0; i < len_len; i++) {
-            *len <<= 8u;
-            *len += *(data + 1 + i);
-        }
-        *valueOffset = 1 + len_len;
-        return 1 + len_len + *len;
+    // lengths must fit in uint16_t
+    *len = 0;
+    *valueOffset = 1 + lenLen;
+    if (lenLen > sizeof(uint16_t))
+        return RLP_ERROR_INVALID_VALUE_LEN;
+    if (end - data < *valueOffset)
+        return RLP_ERROR_TRUNCATED;
+
+    *len = data[1];
+    if (lenLen == 2) {
+        *len = (*len << 8u) | data[2];
     }
 
-    return RLP_NO_ERROR;
+    const uint32_t itemLen = (uint32_t) *valueOffset + *len;
+    if (itemLen > INT16_MAX)
+        return RLP_ERROR_INVALID_VALUE_LEN;
+
+    return itemLen;
+}
+
+int16_t rlp_decodeHeader(const uint8_t *data,
+                         const uint8_t *end,
+                         uint8_t *kind,
+                         uint16_t *len,
+                         uint16_t *valueOffset) {
+    return rlp_decodePrefix(data, end, kind, len, valueOffset);
+}
+
+int16_t rlp_decode(const uint8_t *data,
+                   const uint8_t *end,
+                   uint8_t *kind,
+                   uint16_t *len,
+                   uint16_t *valueOffset) {
+    const int16_t itemLen = rlp_decodePrefix(data, end, kind, len, valueOffset);
+    if (itemLen < 0)
+        return itemLen;
+
+    if (end - data < itemLen)
+        return RLP_ERROR_INVALID_VALUE_LEN;
+
+    return itemLen;
 }
 
 int8_t rlp_parseStream(const uint8_t *data,
@@ -85,10 +114,14 @@ int8_t rlp_parseStream(const uint8_t *data,
     while (offset < dataLen && *fieldCount < maxFieldCount) {
         int16_t bytesConsumed = rlp_decode(
             data + offset,
+            data + dataLen,
             &fields[*fieldCount].kind,
             &fields[*fieldCount].valueLen,
             &fields[*fieldCount].valueOffset);
         fields[*fieldCount].fieldOffset = offset;
+        fields[*fieldCount].parent = RLP_NO_NODE;
+        fields[*fieldCount].firstChild = RLP_NO_NODE;
+        fields[*fieldCount].childCount = 0;
 
         if (bytesConsumed < 0) {
             return bytesConsumed;   // as error
@@ -101,6 +134,257 @@ int8_t rlp_parseStream(const uint8_t *data,
     return RLP_NO_ERROR;
 }
 
+static uint8_t rlp_indexerDepth(const rlp_indexer_t *indexer, uint8_t idx) {
+    uint8_t depth = 0;
+    while (indexer->nodes[idx].parent != RLP_NO_NODE) {
+        idx = indexer->nodes[idx].parent;
+        depth++;
+    }
+    return depth;
+}
+
+// lists deeper than maxDepth are kept as a single node
+static uint8_t rlp_indexerExpands(const rlp_indexer_t *indexer, uint8_t idx) {
+    return indexer->nodes[idx].kind == RLP_KIND_LIST &&
+           (indexer->maxDepth == RLP_NO_MAX_DEPTH || rlp_indexerDepth(indexer, idx) < indexer->maxDepth);
+}
+
+static void rlp_indexerPrepare(rlp_indexer_t *indexer) {
+    if (indexer->current < indexer->nodeCount) {
+        rlp_field_t *node = &indexer->nodes[indexer->current];
+        if (rlp_indexerExpands(indexer, indexer->current)) {
+            node->firstChild = indexer->nodeCount;
+        }
+        indexer->offset = node->fieldOffset + node->valueOffset;
+    }
+}
+
+static void rlp_indexerNext(rlp_indexer_t *indexer) {
+    indexer->current++;
+    rlp_indexerPrepare(indexer);
+}
+
+void rlp_indexerInit(rlp_indexer_t *indexer, rlp_field_t *nodes, uint8_t maxNodeCount, uint8_t maxDepth) {
+    indexer->nodes = nodes;
+    indexer->maxNodeCount = maxNodeCount;
+    indexer->maxDepth = maxDepth;
+    indexer->nodeCount = 0;
+    indexer->current = 0;
+    indexer->offset = 0;
+}
+
+int8_t rlp_indexerFeed(rlp_indexer_t *indexer, const uint8_t *data, uint16_t dataLen) {
+    if (indexer->maxNodeCount == 0) {
+        return RLP_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    if (indexer->nodeCount == 0) {
+        // the root item, its value may not have arrived yet
+        rlp_field_t *root = &indexer->nodes[0];
+        const int16_t err = rlp_decodeHeader(data, data + dataLen, &root->kind, &root->valueLen, &root->valueOffset);
+        if (err == RLP_ERROR_TRUNCATED) {
+            return RLP_NO_ERROR;
+        }
+        if (err < 0) {
+            return err;
+        }
+        root->fieldOffset = 0;
+        root->parent = RLP_NO_NODE;
+        root->firstChild = RLP_NO_NODE;
+        root->childCount = 0;
+        indexer->nodeCount = 1;
+        indexer->current = 0;
+        rlp_indexerPrepare(indexer);
+    }
+
+    // The arena doubles as the work queue: every list is expanded once, in order,
+    // by decoding only the headers of its direct children and appending them
+    while (indexer->current < indexer->nodeCount) {
+        rlp_field_t *node = &indexer->nodes[indexer->current];
+
+        if (!rlp_indexerExpands(indexer, indexer->current)) {
+            rlp_indexerNext(indexer);
+            continue;
+        }
+
+        const uint32_t end = (uint32_t) node->fieldOffset + node->valueOffset + node->valueLen;
+
+        while (indexer->offset < end) {
+            const uint16_t offset = indexer->offset;
+            if (indexer->nodeCount >= indexer->maxNodeCount) {
+                return RLP_ERROR_BUFFER_TOO_SMALL;
+            }
+
+            rlp_field_t *child = &indexer->nodes[indexer->nodeCount];
+            const int16_t err = rlp_decodeHeader(data + offset, data + dataLen,
+                                                 &child->kind, &child->valueLen, &child->valueOffset);
+            if (err == RLP_ERROR_TRUNCATED) {
+                // wait for more data
+                return RLP_NO_ERROR;
+            }
+            if (err < 0) {
+                return err;
+            }
+
+            uint32_t childEnd = (uint32_t) offset + child->valueOffset + child->valueLen;
+            if (child->kind == RLP_KIND_BYTE) {
+                childEnd++;
+            }
+            if (childEnd > end) {
+                return RLP_ERROR_INVALID_VALUE_LEN;
+            }
+
+            child->fieldOffset = offset;
+            child->parent = indexer->current;
+            child->firstChild = RLP_NO_NODE;
+            child->childCount = 0;
+
+            node->childCount++;
+            indexer->nodeCount++;
+            indexer->offset = childEnd;
+        }
+
+        rlp_indexerNext(indexer);
+    }
+
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_indexerFinish(const rlp_indexer_t *indexer, uint16_t dataLen) {
+    if (indexer->nodeCount == 0 || indexer->current < indexer->nodeCount) {
+        return RLP_ERROR_TRUNCATED;
+    }
+
+    // the root item has to be the whole buffer, trailing bytes would be ignored by everything else
+    const rlp_field_t *root = &indexer->nodes[0];
+    uint32_t rootEnd = (uint32_t) root->fieldOffset + root->valueOffset + root->valueLen;
+    if (root->kind == RLP_KIND_BYTE) {
+        rootEnd++;
+    }
+    if (rootEnd > dataLen) {
+        return RLP_ERROR_TRUNCATED;
+    }
+    if (rootEnd != dataLen) {
+        return RLP_ERROR_INVALID_VALUE_LEN;
+    }
+
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_indexStream(const uint8_t *data,
+                       uint16_t dataLen,
+                       rlp_field_t *nodes,
+                       uint8_t maxNodeCount,
+                       uint8_t *nodeCount) {
+    rlp_indexer_t indexer;
+    rlp_indexerInit(&indexer, nodes, maxNodeCount, RLP_NO_MAX_DEPTH);
+
+    int8_t err = rlp_indexerFeed(&indexer, data, dataLen);
+    *nodeCount = indexer.nodeCount;
+    if (err != RLP_NO_ERROR) {
+        return err;
+    }
+
+    return rlp_indexerFinish(&indexer, dataLen);
+}
+
+uint16_t rlp_fieldEnd(const rlp_field_t *field) {
+    if (field->kind == RLP_KIND_BYTE) {
+        return field->fieldOffset + 1;
+    }
+    return field->fieldOffset + field->valueOffset + field->valueLen;
+}
+
+int8_t rlp_iterInit(rlp_iter_t *iter, const uint8_t *data, const rlp_field_t *list) {
+    if (list->kind != RLP_KIND_LIST)
+        return RLP_ERROR_INVALID_KIND;
+
+    iter->data = data;
+    iter->offset = list->fieldOffset + list->valueOffset;
+    iter->end = iter->offset + list->valueLen;
+    return RLP_NO_ERROR;
+}
+
+bool rlp_iterDone(const rlp_iter_t *iter) {
+    return iter->offset >= iter->end;
+}
+
+static int8_t rlp_iterPeek(const rlp_iter_t *iter, rlp_field_t *item) {
+    if (rlp_iterDone(iter))
+        return RLP_ERROR_NO_MORE_ITEMS;
+
+    const int16_t err = rlp_decode(iter->data + iter->offset, iter->data + iter->end,
+                                   &item->kind, &item->valueLen, &item->valueOffset);
+    if (err < 0)
+        return err;
+
+    item->fieldOffset = iter->offset;
+    item->parent = RLP_NO_NODE;
+    item->firstChild = RLP_NO_NODE;
+    item->childCount = 0;
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_iterNext(rlp_iter_t *iter, rlp_field_t *item) {
+    const int8_t err = rlp_iterPeek(iter, item);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    iter->offset = rlp_fieldEnd(item);
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_iterNextUInt256(rlp_iter_t *iter, uint256_t *value) {
+    rlp_field_t item;
+    int8_t err = rlp_iterPeek(iter, &item);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    err = rlp_readUInt256(iter->data, &item, value);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    iter->offset = rlp_fieldEnd(&item);
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_iterNextBytes(rlp_iter_t *iter, const uint8_t **value, uint16_t *valueLen) {
+    rlp_field_t item;
+    const int8_t err = rlp_iterPeek(iter, &item);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    switch (item.kind) {
+        case RLP_KIND_BYTE:
+            *value = iter->data + item.fieldOffset;
+            *valueLen = 1;
+            break;
+        case RLP_KIND_STRING:
+            *value = iter->data + item.fieldOffset + item.valueOffset;
+            *valueLen = item.valueLen;
+            break;
+        default:
+            return RLP_ERROR_INVALID_KIND;
+    }
+
+    iter->offset = rlp_fieldEnd(&item);
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_iterNextList(rlp_iter_t *iter, rlp_iter_t *child) {
+    rlp_field_t item;
+    int8_t err = rlp_iterPeek(iter, &item);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    err = rlp_iterInit(child, iter->data, &item);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    iter->offset = rlp_fieldEnd(&item);
+    return RLP_NO_ERROR;
+}
+
 int8_t rlp_readByte(const uint8_t *data, const rlp_field_t *field, uint8_t *value) {
     if (field->kind != RLP_KIND_BYTE)
         return RLP_ERROR_INVALID_KIND;
@@ -116,44 +400,108 @@ int8_t rlp_readByte(const uint8_t *data, const rlp_field_t *field, uint8_t *valu
     return RLP_NO_ERROR;
 }
 
-int8_t rlp_readStringPaging(const uint8_t *data, const rlp_field_t *field,
-                            char *value, uint16_t maxLen,
-                            uint16_t *valueLen,
-                            uint8_t pageIdx, uint8_t *pageCount) {
-    if (field->kind != RLP_KIND_STRING)
-        return RLP_ERROR_INVALID_KIND;
+int8_t rlp_readBytesLen(const rlp_field_t *field, uint16_t *len) {
+    switch (field->kind) {
+        case RLP_KIND_BYTE:
+            // the byte is its own value and starts at fieldOffset, as valueOffset is 0
+            *len = 1;
+            return RLP_NO_ERROR;
+        case RLP_KIND_STRING:
+            *len = field->valueLen;
+            return RLP_NO_ERROR;
+        default:
+            return RLP_ERROR_INVALID_KIND;
+    }
+}
 
-    MEMSET(value, 0, maxLen);
-    maxLen--;   // need 1 bytes for string termination
+int8_t rlp_pagingInit(rlp_paging_t *paging, const rlp_field_t *field, uint16_t maxLen, uint8_t hex) {
+    uint16_t len;
+    const int8_t err = rlp_readBytesLen(field, &len);
+    if (err != RLP_NO_ERROR)
+        return err;
+    if (maxLen < 3)
+        return RLP_ERROR_BUFFER_TOO_SMALL;
 
-    *pageCount = field->valueLen / maxLen;
-    if (field->valueLen % maxLen > 0) {
-        *pageCount = *pageCount + 1;
+    // 1 char is needed for string termination, and hex pages hold whole bytes
+    paging->hex = hex;
+    paging->pageLen = maxLen - 1;
+    paging->totalLen = len;
+    if (hex) {
+        paging->pageLen &= ~1u;
+        if (len > UINT16_MAX / 2)
+            return RLP_ERROR_INVALID_VALUE_LEN;
+        paging->totalLen *= 2;
     }
 
-    uint16_t pageOffset = pageIdx * maxLen;
-    if (pageOffset > field->valueLen) {
+    const uint16_t pageCount = (paging->totalLen + paging->pageLen - 1) / paging->pageLen;
+    if (pageCount > UINT8_MAX)
+        return RLP_ERROR_INVALID_PAGE;
+    paging->pageCount = pageCount;
+
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_readPage(const uint8_t *data, const rlp_field_t *field,
+                    const rlp_paging_t *paging,
+                    char *value, uint16_t *valueLen,
+                    uint8_t pageIdx) {
+    const uint32_t pageOffset = (uint32_t) pageIdx * paging->pageLen;
+    if (pageOffset > paging->totalLen) {
         return RLP_ERROR_INVALID_PAGE;
     }
 
-    *valueLen = maxLen;
-    const uint16_t bytesLeft = field->valueLen - pageOffset;
-    if (*valueLen > bytesLeft) {
-        *valueLen = bytesLeft;
+    *valueLen = paging->pageLen;
+    if (*valueLen > paging->totalLen - pageOffset) {
+        *valueLen = paging->totalLen - pageOffset;
     }
 
-    MEMCPY(value,
-           data + field->fieldOffset + field->valueOffset + pageOffset,
-           *valueLen);
+    const uint8_t *p = data + field->fieldOffset + field->valueOffset;
+    if (paging->hex) {
+        if (hexEncode(value, *valueLen + 1, p + pageOffset / 2, *valueLen / 2) != UTILS_NOERROR)
+            return RLP_ERROR_BUFFER_TOO_SMALL;
+    } else {
+        MEMCPY(value, p + pageOffset, *valueLen);
+        value[*valueLen] = 0;
+    }
 
     return RLP_NO_ERROR;
 }
 
+static int8_t rlp_readPaging(const uint8_t *data, const rlp_field_t *field,
+                             char *value, uint16_t maxLen,
+                             uint16_t *valueLen,
+                             uint8_t pageIdx, uint8_t *pageCount,
+                             uint8_t hex) {
+    rlp_paging_t paging;
+    const int8_t err = rlp_pagingInit(&paging, field, maxLen, hex);
+    if (err != RLP_NO_ERROR)
+        return err;
+
+    *pageCount = paging.pageCount;
+    return rlp_readPage(data, field, &paging, value, valueLen, pageIdx);
+}
+
+int8_t rlp_readStringPaging(const uint8_t *data, const rlp_field_t *field,
+                            char *value, uint16_t maxLen,
+                            uint16_t *valueLen,
+                            uint8_t pageIdx, uint8_t *pageCount) {
+    return rlp_readPaging(data, field, value, maxLen, valueLen, pageIdx, pageCount, 0);
+}
+
+int8_t rlp_readHexPaging(const uint8_t *data, const rlp_field_t *field,
+                         char *value, uint16_t maxLen,
+                         uint16_t *valueLen,
+                         uint8_t pageIdx, uint8_t *pageCount) {
+    return rlp_readPaging(data, field, value, maxLen, valueLen, pageIdx, pageCount, 1);
+}
+
 int8_t rlp_readString(const uint8_t *data, const rlp_field_t *field, char *value, uint16_t maxLen) {
-    if (field->kind != RLP_KIND_STRING)
-        return RLP_ERROR_INVALID_KIND;
+    uint16_t len;
+    const int8_t err = rlp_readBytesLen(field, &len);
+    if (err != RLP_NO_ERROR)
+        return err;
 
-    if (field->valueLen > maxLen)
+    if (len > maxLen)
         return RLP_ERROR_BUFFER_TOO_SMALL;
 
     uint8_t dummy;
@@ -183,6 +531,9 @@ int8_t rlp_readUInt256(const uint8_t *data,
     if (field->kind == RLP_KIND_STRING) {
         uint8_t tmpBuffer[32];
 
+        if (field->valueLen > 32)
+            return RLP_ERROR_INVALID_VALUE_LEN;
+
         MEMSET(tmpBuffer, 0, 32);
         MEMMOVE(tmpBuffer - field->valueLen + 32,
                 data + field->valueOffset + field->fieldOffset,
@@ -205,3 +556,155 @@ int8_t rlp_readUInt256(const uint8_t *data,
 
     return RLP_ERROR_INVALID_KIND;
 }
+
+int8_t rlp_readUInt64(const uint8_t *data,
+                      const rlp_field_t *field,
+                      uint64_t *value) {
+    if (field->kind == RLP_KIND_BYTE) {
+        *value = data[field->fieldOffset];
+        return RLP_NO_ERROR;
+    }
+
+    if (field->kind != RLP_KIND_STRING)
+        return RLP_ERROR_INVALID_KIND;
+    if (field->valueLen > 32)
+        return RLP_ERROR_INVALID_VALUE_LEN;
+
+    // leading zeros are accepted, as they are by rlp_readUInt256
+    const uint8_t *p = data + field->fieldOffset + field->valueOffset;
+    const uint8_t *end = p + field->valueLen;
+    while (p < end && *p == 0) {
+        p++;
+    }
+    if (end - p > (int32_t) sizeof(uint64_t))
+        return RLP_ERROR_OVERFLOW;
+
+    *value = 0;
+    while (p < end) {
+        *value = (*value << 8u) | *p++;
+    }
+
+    return RLP_NO_ERROR;
+}
+
+// number of bytes needed to write len in big endian
+static uint8_t rlp_lengthLen(uint32_t len) {
+    uint8_t n = 0;
+    while (len > 0) {
+        n++;
+        len >>= 8u;
+    }
+    return n;
+}
+
+static uint32_t rlp_headerLen(uint32_t len) {
+    if (len <= 55)
+        return 1;
+    return 1 + rlp_lengthLen(len);
+}
+
+uint32_t rlp_bytesEncodedLen(const uint8_t *value, uint32_t valueLen) {
+    if (valueLen == 1 && value[0] < 0x80)
+        return 1;
+    return rlp_headerLen(valueLen) + valueLen;
+}
+
+uint32_t rlp_listEncodedLen(uint32_t payloadLen) {
+    return rlp_headerLen(payloadLen) + payloadLen;
+}
+
+uint32_t rlp_uint64EncodedLen(uint64_t value) {
+    if (value < 0x80)
+        return 1;
+    uint8_t n = 0;
+    while (value > 0) {
+        n++;
+        value >>= 8u;
+    }
+    return 1 + n;
+}
+
+// numbers are written big endian without leading zeros
+static uint8_t rlp_uint256Bytes(const uint256_t *value, uint8_t *buffer, const uint8_t **start) {
+    writeu256BE((uint256_t *) value, buffer);
+    uint8_t skip = 0;
+    while (skip < 32 && buffer[skip] == 0) {
+        skip++;
+    }
+    *start = buffer + skip;
+    return 32 - skip;
+}
+
+uint32_t rlp_uint256EncodedLen(const uint256_t *value) {
+    uint8_t buffer[32];
+    const uint8_t *start;
+    const uint8_t len = rlp_uint256Bytes(value, buffer, &start);
+    return rlp_bytesEncodedLen(start, len);
+}
+
+void rlp_encoderInit(rlp_encoder_t *encoder, uint8_t *data, uint32_t maxLen) {
+    encoder->data = data;
+    encoder->maxLen = maxLen;
+    encoder->len = 0;
+}
+
+static int8_t rlp_writeHeader(rlp_encoder_t *encoder, uint8_t offset, uint32_t len) {
+    const uint32_t headerLen = rlp_headerLen(len);
+    if (encoder->maxLen - encoder->len < headerLen)
+        return RLP_ERROR_BUFFER_TOO_SMALL;
+
+    uint8_t *p = encoder->data + encoder->len;
+    if (headerLen == 1) {
+        p[0] = offset + len;
+    } else {
+        // long form: the length of the length follows the short form range
+        p[0] = offset + 55 + (headerLen - 1);
+        for (uint32_t i = headerLen - 1; i > 0; i--) {
+            p[i] = (uint8_t) len;
+            len >>= 8u;
+        }
+    }
+
+    encoder->len += headerLen;
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_writeBytes(rlp_encoder_t *encoder, const uint8_t *value, uint32_t valueLen) {
+    if (encoder->maxLen - encoder->len < rlp_bytesEncodedLen(value, valueLen))
+        return RLP_ERROR_BUFFER_TOO_SMALL;
+
+    if (!(valueLen == 1 && value[0] < 0x80)) {
+        rlp_writeHeader(encoder, 0x80, valueLen);
+    }
+    // empty values may come without a buffer
+    if (valueLen > 0) {
+        MEMCPY(encoder->data + encoder->len, value, valueLen);
+        encoder->len += valueLen;
+    }
+
+    return RLP_NO_ERROR;
+}
+
+int8_t rlp_writeListHeader(rlp_encoder_t *encoder, uint32_t payloadLen) {
+    return rlp_writeHeader(encoder, 0xC0, payloadLen);
+}
+
+int8_t rlp_writeUInt64(rlp_encoder_t *encoder, uint64_t value) {
+    uint8_t buffer[8];
+    uint8_t len = 0;
+    for (uint64_t tmp = value; tmp > 0; tmp >>= 8u) {
+        len++;
+    }
+    for (uint8_t i = len; i > 0; i--) {
+        buffer[i - 1] = (uint8_t) value;
+        value >>= 8u;
+    }
+    return rlp_writeBytes(encoder, buffer, len);
+}
+
+int8_t rlp_writeUInt256(rlp_encoder_t *encoder, const uint256_t *value) {
+    uint8_t buffer[32];
+    const uint8_t *start;
+    const uint8_t len = rlp_uint256Bytes(value, buffer, &start);
+    return rlp_writeBytes(encoder, start, len);
+}
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <zxmacros.h>
 #include "utils/uint256.h"
 
@@ -29,6 +30,12 @@
 #define RLP_ERROR_INVALID_FIELD_OFFSET  -3
 #define RLP_ERROR_BUFFER_TOO_SMALL  -4
 #define RLP_ERROR_INVALID_PAGE  -5
+#define RLP_ERROR_TRUNCATED  -6
+#define RLP_ERROR_NO_MORE_ITEMS  -7
+#define RLP_ERROR_OVERFLOW  -8
+
+#define RLP_NO_NODE  0xFF
+#define RLP_NO_MAX_DEPTH  0xFF
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,12 +43,27 @@ extern "C" {
 
 typedef struct {
     uint8_t kind;
+    // Links into the node arena built by rlp_indexStream
+    // Children of a list are stored contiguously, so the next sibling of a node is the following node
+    uint8_t parent;
+    uint8_t firstChild;
+    uint8_t childCount;
     uint16_t fieldOffset;
     uint16_t valueOffset;
     uint16_t valueLen;
 } rlp_field_t;
 
+// decodes the header of the item at data. Only the header has to be before end
+// returns the size of the whole item or an error (RLP_ERROR_TRUNCATED if the header does not fit)
+int16_t rlp_decodeHeader(const uint8_t *data,
+                         const uint8_t *end,
+                         uint8_t *kind,
+                         uint16_t *len,
+                         uint16_t *valueOffset);
+
+// decodes the item at data. The whole item has to be before end
 int16_t rlp_decode(const uint8_t *data,
+                   const uint8_t *end,
                    uint8_t *kind,
                    uint16_t *len,
                    uint16_t *valueOffset);
@@ -54,12 +76,94 @@ int8_t rlp_parseStream(const uint8_t *data,
                        uint8_t maxFieldCount,
                        uint16_t *fieldCount);
 
+// Resumable indexer state. Only offsets are kept so the buffer may move between calls
+typedef struct {
+    rlp_field_t *nodes;
+    uint8_t maxNodeCount;
+    uint8_t maxDepth;       // lists at this depth are indexed but their items are not (root is depth 0)
+    uint8_t nodeCount;
+    uint8_t current;        // list that is being expanded
+    uint16_t offset;        // next child header to decode inside the current list
+} rlp_indexer_t;
+
+// prepares the indexer to fill the given node arena
+void rlp_indexerInit(rlp_indexer_t *indexer, rlp_field_t *nodes, uint8_t maxNodeCount, uint8_t maxDepth);
+
+// indexes as much as possible with the bytes received so far (data may grow between calls)
+// returns RLP_NO_ERROR while the structure is valid, even if more data is needed
+int8_t rlp_indexerFeed(rlp_indexer_t *indexer, const uint8_t *data, uint16_t dataLen);
+
+// checks that the whole tree has been indexed and that it fits in the buffer
+int8_t rlp_indexerFinish(const rlp_indexer_t *indexer, uint16_t dataLen);
+
+// walks the buffer once and indexes the whole tree into a flat arena of nodes
+// nodes are stored breadth-first: node 0 is the root and the children of every list are contiguous
+int8_t rlp_indexStream(const uint8_t *data,
+                       uint16_t dataLen,
+                       rlp_field_t *nodes,
+                       uint8_t maxNodeCount,
+                       uint8_t *nodeCount);
+
+// returns the offset right after the field
+uint16_t rlp_fieldEnd(const rlp_field_t *field);
+
+// Walks the items of a list one at a time
+typedef struct {
+    const uint8_t *data;
+    uint16_t offset;        // next item
+    uint16_t end;           // end of the list
+} rlp_iter_t;
+
+// prepares an iterator over the items of the list
+int8_t rlp_iterInit(rlp_iter_t *iter, const uint8_t *data, const rlp_field_t *list);
+
+// returns true when there are no items left
+bool rlp_iterDone(const rlp_iter_t *iter);
+
+// decodes the next item. On error the iterator does not move
+int8_t rlp_iterNext(rlp_iter_t *iter, rlp_field_t *item);
+
+// reads the next item as a variable uint256
+int8_t rlp_iterNextUInt256(rlp_iter_t *iter, uint256_t *value);
+
+// points value to the contents of the next item, that must be a string or a single byte
+int8_t rlp_iterNextBytes(rlp_iter_t *iter, const uint8_t **value, uint16_t *valueLen);
+
+// prepares child to walk the next item, that must be a list
+int8_t rlp_iterNextList(rlp_iter_t *iter, rlp_iter_t *child);
+
 // reads a byte from the field
 int8_t rlp_readByte(const uint8_t *data,
                     const rlp_field_t *field,
                     uint8_t *value);
 
-// reads a buffer into value. These are not actually zero terminate strings but buffers
+// length of the value of a string or single byte field, which starts at fieldOffset + valueOffset
+int8_t rlp_readBytesLen(const rlp_field_t *field, uint16_t *len);
+
+// Page geometry of a string field for a given output size
+// It only depends on the field length, so it can be computed once and reused for every page
+typedef struct {
+    uint16_t pageLen;       // chars per page, all pages but the last one are full
+    uint16_t totalLen;      // chars of the whole rendered value
+    uint8_t pageCount;
+    uint8_t hex;            // bytes are rendered as two hex chars
+} rlp_paging_t;
+
+// computes the geometry of the field for outputs of maxLen chars (including the terminator)
+int8_t rlp_pagingInit(rlp_paging_t *paging,
+                      const rlp_field_t *field,
+                      uint16_t maxLen,
+                      uint8_t hex);
+
+// renders page pageIdx with a precomputed geometry: a bounded copy (or encode) and a terminator
+int8_t rlp_readPage(const uint8_t *data,
+                    const rlp_field_t *field,
+                    const rlp_paging_t *paging,
+                    char *value,
+                    uint16_t *valueLen,
+                    uint8_t pageIdx);
+
+// reads a page of the field into value, zero terminated
 int8_t rlp_readStringPaging(const uint8_t *data,
                             const rlp_field_t *field,
                             char *value,
@@ -68,6 +172,16 @@ int8_t rlp_readStringPaging(const uint8_t *data,
                             uint8_t pageIdx,
                             uint8_t *pageCount);
 
+// renders a page of the field as a zero terminated hexstring, straight from data
+// pages are measured in output chars: every page but the last one holds (maxLen - 1) rounded down to even chars
+int8_t rlp_readHexPaging(const uint8_t *data,
+                         const rlp_field_t *field,
+                         char *value,
+                         uint16_t maxLen,
+                         uint16_t *valueLen,
+                         uint8_t pageIdx,
+                         uint8_t *pageCount);
+
 // reads a buffer into value. These are not actually zero terminate strings but buffers
 int8_t rlp_readString(const uint8_t *data,
                       const rlp_field_t *field,
@@ -86,6 +200,43 @@ int8_t rlp_readUInt256(const uint8_t *data,
                        const rlp_field_t *field,
                        uint256_t *value);
 
+// reads a variable uint64. Returns RLP_ERROR_OVERFLOW if the value does not fit (it can still be read as uint256)
+int8_t rlp_readUInt64(const uint8_t *data,
+                      const rlp_field_t *field,
+                      uint64_t *value);
+
+////////// Encoding
+// Sizes are computed first with the rlp_*EncodedLen functions, so that a single
+// write pass fills a buffer of the exact size
+
+// size of an encoded string
+uint32_t rlp_bytesEncodedLen(const uint8_t *value, uint32_t valueLen);
+
+// size of an encoded list with a payload of payloadLen bytes
+uint32_t rlp_listEncodedLen(uint32_t payloadLen);
+
+// size of an encoded unsigned number
+uint32_t rlp_uint64EncodedLen(uint64_t value);
+
+uint32_t rlp_uint256EncodedLen(const uint256_t *value);
+
+typedef struct {
+    uint8_t *data;
+    uint32_t maxLen;
+    uint32_t len;           // bytes written so far
+} rlp_encoder_t;
+
+void rlp_encoderInit(rlp_encoder_t *encoder, uint8_t *data, uint32_t maxLen);
+
+int8_t rlp_writeBytes(rlp_encoder_t *encoder, const uint8_t *value, uint32_t valueLen);
+
+// writes the header of a list. The payloadLen bytes of items have to follow
+int8_t rlp_writeListHeader(rlp_encoder_t *encoder, uint32_t payloadLen);
+
+int8_t rlp_writeUInt64(rlp_encoder_t *encoder, uint64_t value);
+
+int8_t rlp_writeUInt256(rlp_encoder_t *encoder, const uint256_t *value);
+
 #ifdef __cplusplus
 }
 #endif
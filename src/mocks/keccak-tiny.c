@@ -136,3 +136,64 @@ int keccak_hash(uint8_t* out, size_t outlen,
   memset(a, 0, 200);
   return 0;
 }
+
+/** The same sponge, absorbing the input in pieces. **/
+int keccak_init(keccak_ctx_t* ctx, size_t rate, uint8_t delim) {
+  if ((ctx == NULL) || (rate >= Plen)) {
+    return -1;
+  }
+  memset(ctx->a, 0, Plen);
+  ctx->offset = 0;
+  ctx->rate = rate;
+  ctx->delim = delim;
+  return 0;
+}
+
+int keccak_update(keccak_ctx_t* ctx, const uint8_t* in, size_t inlen) {
+  if ((ctx == NULL) || ((in == NULL) && inlen != 0)) {
+    return -1;
+  }
+  uint8_t* a = ctx->a;
+  const size_t rate = ctx->rate;
+  // Top up a partially absorbed block first.
+  if (ctx->offset > 0) {
+    size_t n = rate - ctx->offset;
+    if (n > inlen) {
+      n = inlen;
+    }
+    xorin(a + ctx->offset, in, n);
+    ctx->offset += n;
+    in += n;
+    inlen -= n;
+    if (ctx->offset < rate) {
+      return 0;
+    }
+    P(a);
+    ctx->offset = 0;
+  }
+  // Absorb full blocks.
+  foldP(in, inlen, xorin);
+  // Keep the tail for later.
+  xorin(a, in, inlen);
+  ctx->offset = inlen;
+  return 0;
+}
+
+int keccak_final(keccak_ctx_t* ctx, uint8_t* out, size_t outlen) {
+  if ((ctx == NULL) || (out == NULL)) {
+    return -1;
+  }
+  uint8_t* a = ctx->a;
+  const size_t rate = ctx->rate;
+  // Xor in the DS and pad frame.
+  a[ctx->offset] ^= ctx->delim;
+  a[rate - 1] ^= 0x80;
+  // Apply P
+  P(a);
+  // Squeeze output.
+  foldP(out, outlen, setout);
+  setout(a, out, outlen);
+  memset(ctx->a, 0, Plen);
+  ctx->offset = 0;
+  return 0;
+}
@@ -16,6 +16,20 @@ int keccak_hash(uint8_t *out, size_t outlen,
                 const uint8_t *in, size_t inlen,
                 size_t rate, uint8_t delim);
 
+// Incremental version of keccak_hash
+typedef struct {
+    uint8_t a[200];
+    size_t offset;
+    size_t rate;
+    uint8_t delim;
+} keccak_ctx_t;
+
+int keccak_init(keccak_ctx_t *ctx, size_t rate, uint8_t delim);
+
+int keccak_update(keccak_ctx_t *ctx, const uint8_t *in, size_t inlen);
+
+int keccak_final(keccak_ctx_t *ctx, uint8_t *out, size_t outlen);
+
 #ifdef __cplusplus
 }
 #endif
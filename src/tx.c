@@ -47,6 +47,7 @@ storage_t const N_appdata_impl __attribute__ ((aligned(64)));
 #endif
 
 parser_context_t ctx_parsed_tx;
+parser_tx_t parser_tx_obj;
 
 void tx_initialize() {
     buffering_init(
@@ -59,6 +60,7 @@ void tx_initialize() {
 
 void tx_reset() {
     buffering_reset();
+    parser_parseStart(&parser_tx_obj);
 }
 
 uint32_t tx_append(unsigned char *buffer, uint32_t length) {
@@ -73,11 +75,27 @@ uint8_t *tx_get_buffer() {
     return buffering_get_buffer()->data;
 }
 
+const char *tx_parse_chunk() {
+    uint8_t err = parser_parseChunk(
+        &ctx_parsed_tx,
+        tx_get_buffer(),
+        tx_get_buffer_length(),
+        &parser_tx_obj);
+
+    if (err != parser_ok) {
+        return parser_getErrorDescription(err);
+    }
+
+    return NULL;
+}
+
 const char *tx_parse() {
-    uint8_t err = parser_parse(
+    // the index was started by tx_reset and fed by tx_parse_chunk
+    uint8_t err = parser_parseFinish(
         &ctx_parsed_tx,
         tx_get_buffer(),
-        tx_get_buffer_length());
+        tx_get_buffer_length(),
+        &parser_tx_obj);
 
     if (err != parser_ok) {
         return parser_getErrorDescription(err);
@@ -91,11 +109,11 @@ const char *tx_parse() {
     return NULL;
 }
 
-uint8_t tx_getNumItems() {
+uint16_t tx_getNumItems() {
     return parser_getNumItems(&ctx_parsed_tx);
 }
 
-tx_error_t tx_getItem(int8_t displayIdx,
+tx_error_t tx_getItem(int16_t displayIdx,
                       char *outKey, uint16_t outKeyLen,
                       char *outVal, uint16_t outValLen,
                       uint8_t pageIdx, uint8_t *pageCount) {
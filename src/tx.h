@@ -43,16 +43,21 @@ uint32_t tx_get_buffer_length();
 /// \return
 uint8_t *tx_get_buffer();
 
+/// Incrementally parse the part of the message received so far
+/// This function can be called after each chunk to reject malformed data early.
+/// \return It returns NULL if the data is valid so far or error message otherwise.
+const char *tx_parse_chunk();
+
 /// Parse message stored in transaction buffer
 /// This function should be called as soon as full buffer data is loaded.
 /// \return It returns NULL if json is valid or error message otherwise.
 const char *tx_parse();
 
 /// Return the number of items in the transaction
-uint8_t tx_getNumItems();
+uint16_t tx_getNumItems();
 
 /// Gets an specific item from the transaction (including paging)
-tx_error_t tx_getItem(int8_t displayIdx,
+tx_error_t tx_getItem(int16_t displayIdx,
                            char *outKey, uint16_t outKeyLen,
                            char *outValue, uint16_t outValueLen,
                            uint8_t pageIdx, uint8_t *pageCount);
@@ -148,6 +148,75 @@ int encode_base58(const unsigned char *in, size_t length,
     return 0;
 }
 
+// 20 bytes are handled as five 32 bit limbs and converted to base 58^5,
+// so each (64 bit / 32 bit) division step produces 5 digits at once
+#define B58_20_INPUT_SIZE       20
+#define B58_20_LIMB_COUNT       5
+#define B58_20_CHUNK            656356768u      // 58^5
+#define B58_20_CHUNK_DIGITS     5
+#define B58_20_CHUNK_COUNT      6               // 58^30 > 2^160
+#define B58_20_MAX_DIGITS       (B58_20_CHUNK_COUNT * B58_20_CHUNK_DIGITS)
+
+int encode_base58_20(const unsigned char *in,
+                     unsigned char *out, size_t *outlen) {
+    uint32_t limbs[B58_20_LIMB_COUNT];
+    unsigned char digits[B58_20_MAX_DIGITS];
+    size_t zeroCount = 0;
+
+    while ((zeroCount < B58_20_INPUT_SIZE) && (in[zeroCount] == 0)) {
+        ++zeroCount;
+    }
+
+    for (uint8_t i = 0; i < B58_20_LIMB_COUNT; i++) {
+        limbs[i] = ((uint32_t) in[4 * i] << 24u) | ((uint32_t) in[4 * i + 1] << 16u) |
+                   ((uint32_t) in[4 * i + 2] << 8u) | ((uint32_t) in[4 * i + 3]);
+    }
+
+    size_t pos = B58_20_MAX_DIGITS;
+    for (uint8_t c = 0; c < B58_20_CHUNK_COUNT; c++) {
+        uint64_t rem = 0;
+        for (uint8_t i = 0; i < B58_20_LIMB_COUNT; i++) {
+            const uint64_t cur = (rem << 32u) | limbs[i];
+            limbs[i] = (uint32_t) (cur / B58_20_CHUNK);
+            rem = cur % B58_20_CHUNK;
+        }
+
+        uint32_t chunk = (uint32_t) rem;
+        for (uint8_t i = 0; i < B58_20_CHUNK_DIGITS; i++) {
+            digits[--pos] = (unsigned char) (chunk % 58);
+            chunk /= 58;
+        }
+    }
+
+    // leading zero digits are not encoded, leading zero bytes are
+    while (pos < B58_20_MAX_DIGITS && digits[pos] == 0) {
+        pos++;
+    }
+
+    const size_t digitCount = B58_20_MAX_DIGITS - pos;
+    if (*outlen < zeroCount + digitCount) {
+        *outlen = zeroCount + digitCount;
+        return -1;
+    }
+
+    MEMSET(out, BASE58ALPHABET[0], zeroCount);
+
+    size_t i = zeroCount;
+    while (pos < B58_20_MAX_DIGITS) {
+        out[i++] = BASE58ALPHABET[digits[pos++]];
+    }
+    *outlen = i;
+    return 0;
+}
+
 char encode_base58_clip(unsigned char v) {
     return BASE58ALPHABET[v % 58];
 }
+
+int decode_base58_digit(char c) {
+    const unsigned char u = (unsigned char) c;
+    if (u >= sizeof(BASE58TABLE) || BASE58TABLE[u] == 0xff) {
+        return -1;
+    }
+    return BASE58TABLE[u];
+}
@@ -31,8 +31,15 @@ int decode_base58(const char *in, size_t length,
 int encode_base58(const unsigned char *in, size_t length,
                   unsigned char *out, size_t *outlen);
 
+// Same output as encode_base58 for a fixed 20 byte input (e.g. addresses)
+int encode_base58_20(const unsigned char *in,
+                     unsigned char *out, size_t *outlen);
+
 char encode_base58_clip(unsigned char v);
 
+// returns the value of a base58 digit or -1 if it is not in the alphabet
+int decode_base58_digit(char c);
+
 #ifdef __cplusplus
 }
 #endif
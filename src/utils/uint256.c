@@ -22,6 +22,11 @@
 
 #include "uint256.h"
 
+// Device builds use the portable code. UINT256_PORTABLE forces it on hosts too
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX) && !defined(UINT256_PORTABLE) && defined(__SIZEOF_INT128__)
+#define UINT256_NATIVE
+#endif
+
 static const char HEXDIGITS[] = "0123456789abcdef";
 
 static uint64_t readUint64BE(uint8_t *buffer) {
@@ -41,6 +46,23 @@ void readu256BE(uint8_t *buffer, uint256_t *target) {
     readu128BE(buffer + 16, &LOWER_P(target));
 }
 
+static void writeUint64BE(uint64_t value, uint8_t *buffer) {
+    for (int8_t i = 7; i >= 0; i--) {
+        buffer[i] = (uint8_t) value;
+        value >>= 8;
+    }
+}
+
+void writeu128BE(uint128_t *number, uint8_t *buffer) {
+    writeUint64BE(UPPER_P(number), buffer);
+    writeUint64BE(LOWER_P(number), buffer + 8);
+}
+
+void writeu256BE(uint256_t *number, uint8_t *buffer) {
+    writeu128BE(&UPPER_P(number), buffer);
+    writeu128BE(&LOWER_P(number), buffer + 16);
+}
+
 bool zero128(uint128_t *number) {
     return ((LOWER_P(number) == 0) && (UPPER_P(number) == 0));
 }
@@ -233,6 +255,83 @@ bool gte256(uint256_t *number1, uint256_t *number2) {
     return gt256(number1, number2) || equal256(number1, number2);
 }
 
+void or128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
+    UPPER_P(target) = UPPER_P(number1) | UPPER_P(number2);
+    LOWER_P(target) = LOWER_P(number1) | LOWER_P(number2);
+}
+
+void or256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
+    or128(&UPPER_P(number1), &UPPER_P(number2), &UPPER_P(target));
+    or128(&LOWER_P(number1), &LOWER_P(number2), &LOWER_P(target));
+}
+
+#if defined(UINT256_NATIVE)
+// Host backend: 128-bit values map to a native type and carries come from the compiler builtins
+typedef unsigned __int128 native128_t;
+
+static inline native128_t toNative128(const uint128_t *number) {
+    return ((native128_t) UPPER_P(number) << 64u) | LOWER_P(number);
+}
+
+static inline void fromNative128(native128_t value, uint128_t *target) {
+    UPPER_P(target) = (uint64_t) (value >> 64u);
+    LOWER_P(target) = (uint64_t) value;
+}
+
+void add128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
+    fromNative128(toNative128(number1) + toNative128(number2), target);
+}
+
+void add256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
+    native128_t lower;
+    const bool carry = __builtin_add_overflow(toNative128(&LOWER_P(number1)), toNative128(&LOWER_P(number2)), &lower);
+    const native128_t upper = toNative128(&UPPER_P(number1)) + toNative128(&UPPER_P(number2)) + carry;
+    fromNative128(upper, &UPPER_P(target));
+    fromNative128(lower, &LOWER_P(target));
+}
+
+void minus128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
+    fromNative128(toNative128(number1) - toNative128(number2), target);
+}
+
+void minus256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
+    native128_t lower;
+    const bool borrow = __builtin_sub_overflow(toNative128(&LOWER_P(number1)), toNative128(&LOWER_P(number2)), &lower);
+    const native128_t upper = toNative128(&UPPER_P(number1)) - toNative128(&UPPER_P(number2)) - borrow;
+    fromNative128(upper, &UPPER_P(target));
+    fromNative128(lower, &LOWER_P(target));
+}
+
+void mul128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
+    fromNative128(toNative128(number1) * toNative128(number2), target);
+}
+
+// Schoolbook product on 64-bit limbs, least significant first, keeping the lower 256 bits
+void mul256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
+    const uint64_t a[4] = {LOWER(LOWER_P(number1)), UPPER(LOWER_P(number1)),
+                           LOWER(UPPER_P(number1)), UPPER(UPPER_P(number1))};
+    const uint64_t b[4] = {LOWER(LOWER_P(number2)), UPPER(LOWER_P(number2)),
+                           LOWER(UPPER_P(number2)), UPPER(UPPER_P(number2))};
+    uint64_t r[4] = {0, 0, 0, 0};
+
+    for (uint8_t i = 0; i < 4; i++) {
+        uint64_t carry = 0;
+        for (uint8_t j = 0; i + j < 4; j++) {
+            const native128_t t = (native128_t) a[i] * b[j] + r[i + j] + carry;
+            r[i + j] = (uint64_t) t;
+            carry = (uint64_t) (t >> 64u);
+        }
+    }
+
+    LOWER(LOWER_P(target)) = r[0];
+    UPPER(LOWER_P(target)) = r[1];
+    LOWER(UPPER_P(target)) = r[2];
+    UPPER(UPPER_P(target)) = r[3];
+}
+
+#else
+// Portable backend: 128-bit arithmetic is emulated with 64-bit halves and 32-bit partial products
+
 void add128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
     UPPER_P(target) =
         UPPER_P(number1) + UPPER_P(number2) +
@@ -273,16 +372,6 @@ void minus256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
     minus128(&LOWER_P(number1), &LOWER_P(number2), &LOWER_P(target));
 }
 
-void or128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
-    UPPER_P(target) = UPPER_P(number1) | UPPER_P(number2);
-    LOWER_P(target) = LOWER_P(number1) | LOWER_P(number2);
-}
-
-void or256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
-    or128(&UPPER_P(number1), &UPPER_P(number2), &UPPER_P(target));
-    or128(&LOWER_P(number1), &LOWER_P(number2), &LOWER_P(target));
-}
-
 void mul128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
     uint64_t top[4] = {UPPER_P(number1) >> 32, UPPER_P(number1) & 0xffffffff,
                        LOWER_P(number1) >> 32, LOWER_P(number1) & 0xffffffff};
@@ -325,100 +414,41 @@ void mul128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
     add128(&tmp, &tmp2, target);
 }
 
-void mul256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
-    uint128_t top[4];
-    uint128_t bottom[4];
-    uint128_t products[4][4];
-    uint128_t tmp, tmp2, fourth64, third64, second64, first64;
-    uint256_t target1, target2;
-    UPPER(top[0]) = 0;
-    LOWER(top[0]) = UPPER(UPPER_P(number1));
-    UPPER(top[1]) = 0;
-    LOWER(top[1]) = LOWER(UPPER_P(number1));
-    UPPER(top[2]) = 0;
-    LOWER(top[2]) = UPPER(LOWER_P(number1));
-    UPPER(top[3]) = 0;
-    LOWER(top[3]) = LOWER(LOWER_P(number1));
-    UPPER(bottom[0]) = 0;
-    LOWER(bottom[0]) = UPPER(UPPER_P(number2));
-    UPPER(bottom[1]) = 0;
-    LOWER(bottom[1]) = LOWER(UPPER_P(number2));
-    UPPER(bottom[2]) = 0;
-    LOWER(bottom[2]) = UPPER(LOWER_P(number2));
-    UPPER(bottom[3]) = 0;
-    LOWER(bottom[3]) = LOWER(LOWER_P(number2));
+static void toLimbs32(uint256_t *number, uint32_t *limbs) {
+    const uint64_t words[4] = {LOWER(LOWER_P(number)), UPPER(LOWER_P(number)),
+                               LOWER(UPPER_P(number)), UPPER(UPPER_P(number))};
+    for (uint8_t i = 0; i < 4; i++) {
+        limbs[2 * i] = (uint32_t) words[i];
+        limbs[2 * i + 1] = (uint32_t) (words[i] >> 32u);
+    }
+}
 
-    for (int y = 3; y > -1; y--) {
-        for (int x = 3; x > -1; x--) {
-            mul128(&top[x], &bottom[y], &products[3 - x][y]);
+// Schoolbook product on 32-bit limbs, least significant first, keeping the lower 256 bits
+// Every partial sum fits in 64 bits: (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1
+void mul256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
+    uint32_t a[8];
+    uint32_t b[8];
+    uint32_t r[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    toLimbs32(number1, a);
+    toLimbs32(number2, b);
+
+    for (uint8_t i = 0; i < 8; i++) {
+        uint32_t carry = 0;
+        for (uint8_t j = 0; i + j < 8; j++) {
+            const uint64_t t = (uint64_t) a[i] * b[j] + r[i + j] + carry;
+            r[i + j] = (uint32_t) t;
+            carry = (uint32_t) (t >> 32u);
         }
     }
 
-    UPPER(fourth64) = 0;
-    LOWER(fourth64) = LOWER(products[0][3]);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][2]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][3]);
-    add128(&tmp, &tmp2, &third64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][1]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][2]);
-    add128(&tmp, &tmp2, &second64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][0]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][1]);
-    add128(&tmp, &tmp2, &first64);
-
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][3]);
-    add128(&tmp, &third64, &tmp2);
-    copy128(&third64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][2]);
-    add128(&tmp, &second64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[1][3]);
-    add128(&tmp, &tmp2, &second64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][1]);
-    add128(&tmp, &first64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[1][2]);
-    add128(&tmp, &tmp2, &first64);
-
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[2][3]);
-    add128(&tmp, &second64, &tmp2);
-    copy128(&second64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[2][2]);
-    add128(&tmp, &first64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[2][3]);
-    add128(&tmp, &tmp2, &first64);
-
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[3][3]);
-    add128(&tmp, &first64, &tmp2);
-    copy128(&first64, &tmp2);
-
-    clear256(&target1);
-    shiftl128(&first64, 64, &UPPER(target1));
-    clear256(&target2);
-    UPPER(UPPER(target2)) = UPPER(third64);
-    shiftl128(&third64, 64, &LOWER(target2));
-    add256(&target1, &target2, target);
-    clear256(&target1);
-    copy128(&UPPER(target1), &second64);
-    add256(&target1, target, &target2);
-    clear256(&target1);
-    copy128(&LOWER(target1), &fourth64);
-    add256(&target1, &target2, target);
+    LOWER(LOWER_P(target)) = ((uint64_t) r[1] << 32u) | r[0];
+    UPPER(LOWER_P(target)) = ((uint64_t) r[3] << 32u) | r[2];
+    LOWER(UPPER_P(target)) = ((uint64_t) r[5] << 32u) | r[4];
+    UPPER(UPPER_P(target)) = ((uint64_t) r[7] << 32u) | r[6];
 }
 
+#endif
+
 void divmod128(uint128_t *l, uint128_t *r, uint128_t *retDiv,
                uint128_t *retMod) {
     uint128_t copyd, adder, resDiv, resMod;
@@ -519,8 +549,105 @@ bool tostring128(uint128_t *number, uint32_t baseParam, char *out,
     return true;
 }
 
+// Decimal conversion works on machine words instead of bits: the number is
+// repeatedly divided by the largest power of ten that fits in a limb
+#if defined(UINT256_NATIVE)
+typedef uint64_t dec_limb_t;
+typedef unsigned __int128 dec_wide_t;
+#define DEC_LIMB_COUNT      4
+#define DEC_LIMB_BITS       64
+#define DEC_CHUNK           10000000000000000000ULL
+#define DEC_CHUNK_DIGITS    19
+#else
+typedef uint32_t dec_limb_t;
+typedef uint64_t dec_wide_t;
+#define DEC_LIMB_COUNT      8
+#define DEC_LIMB_BITS       32
+#define DEC_CHUNK           1000000000UL
+#define DEC_CHUNK_DIGITS    9
+#endif
+
+// 78 digits at most, rounded up to full chunks
+#define DEC_MAX_DIGITS      (((78 + DEC_CHUNK_DIGITS - 1) / DEC_CHUNK_DIGITS) * DEC_CHUNK_DIGITS)
+
+static void toLimbs256(uint256_t *number, dec_limb_t *limbs) {
+    const uint64_t words[4] = {
+        UPPER(UPPER_P(number)), LOWER(UPPER_P(number)),
+        UPPER(LOWER_P(number)), LOWER(LOWER_P(number)),
+    };
+#if DEC_LIMB_BITS == 64
+    for (uint8_t i = 0; i < 4; i++) {
+        limbs[i] = words[i];
+    }
+#else
+    for (uint8_t i = 0; i < 4; i++) {
+        limbs[2 * i] = (dec_limb_t) (words[i] >> 32u);
+        limbs[2 * i + 1] = (dec_limb_t) words[i];
+    }
+#endif
+}
+
+// divides limbs[first..] in place by DEC_CHUNK and returns the remainder
+static dec_limb_t divChunkLimbs(dec_limb_t *limbs, uint8_t first) {
+    dec_wide_t rem = 0;
+    for (uint8_t i = first; i < DEC_LIMB_COUNT; i++) {
+        const dec_wide_t cur = (rem << DEC_LIMB_BITS) | limbs[i];
+        limbs[i] = (dec_limb_t) (cur / DEC_CHUNK);
+        rem = cur % DEC_CHUNK;
+    }
+    return (dec_limb_t) rem;
+}
+
+static bool tostring256_dec(uint256_t *number, char *out, uint32_t outLength) {
+    dec_limb_t limbs[DEC_LIMB_COUNT];
+    char digits[DEC_MAX_DIGITS];
+    uint32_t pos = DEC_MAX_DIGITS;
+
+    toLimbs256(number, limbs);
+
+    uint8_t first = 0;
+    while (first < DEC_LIMB_COUNT && limbs[first] == 0) {
+        first++;
+    }
+
+    // Each division yields DEC_CHUNK_DIGITS digits, least significant first
+    while (first < DEC_LIMB_COUNT) {
+        dec_limb_t chunk = divChunkLimbs(limbs, first);
+        for (uint8_t i = 0; i < DEC_CHUNK_DIGITS; i++) {
+            digits[--pos] = (char) ('0' + (chunk % 10));
+            chunk /= 10;
+        }
+        while (first < DEC_LIMB_COUNT && limbs[first] == 0) {
+            first++;
+        }
+    }
+
+    // Drop leading zeros of the last chunk, keeping at least one digit
+    while (pos < DEC_MAX_DIGITS - 1 && digits[pos] == '0') {
+        pos++;
+    }
+    if (pos == DEC_MAX_DIGITS) {
+        digits[--pos] = '0';
+    }
+
+    const uint32_t len = DEC_MAX_DIGITS - pos;
+    if (outLength == 0 || len > outLength - 1) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < len; i++) {
+        out[i] = digits[pos + i];
+    }
+    out[len] = '\0';
+    return true;
+}
+
 bool tostring256(uint256_t *number, uint32_t baseParam, char *out,
                  uint32_t outLength) {
+    if (baseParam == 10) {
+        return tostring256_dec(number, out, outLength);
+    }
+
     uint256_t rDiv;
     uint256_t rMod;
     uint256_t base;
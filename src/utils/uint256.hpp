@@ -0,0 +1,449 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Header-only C++17 value type over uint256_t for host tooling
+// Every operation is constexpr, so constants are folded at compile time and
+// values stay in registers instead of going through pointer out parameters.
+// The words are stored in the same order as uint256_t, most significant first
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include "uint256.h"
+
+namespace mantx {
+
+class uint256 {
+public:
+    static constexpr size_t WORDS = 4;
+    // 2^256 - 1 has 78 digits
+    static constexpr size_t MAX_DECIMAL_DIGITS = 78;
+    static constexpr size_t MAX_HEX_DIGITS = 64;
+
+    using decimal_string = std::array<char, MAX_DECIMAL_DIGITS + 1>;
+    using hex_string = std::array<char, MAX_HEX_DIGITS + 1>;
+
+    constexpr uint256() : w{0, 0, 0, 0} {}
+
+    constexpr uint256(uint64_t value) : w{0, 0, 0, value} {}
+
+    constexpr uint256(const uint256_t &v)
+            : w{v.elements[0].elements[0], v.elements[0].elements[1],
+                v.elements[1].elements[0], v.elements[1].elements[1]} {}
+
+    constexpr uint256_t to_c() const {
+        return uint256_t{{uint128_t{{w[0], w[1]}}, uint128_t{{w[2], w[3]}}}};
+    }
+
+    // word i, 0 being the most significant
+    constexpr uint64_t word(size_t i) const { return w[i]; }
+
+    // big endian bytes, as found in RLP fields
+    // Shorter inputs are left padded with zeros
+    template<size_t N>
+    static constexpr uint256 from_be_bytes(const uint8_t (&bytes)[N]) {
+        static_assert(N <= 32, "a uint256 holds at most 32 bytes");
+        uint256 r;
+        r.readBE(bytes, N);
+        return r;
+    }
+
+    // Same as above for a runtime length. Returns false if len > 32
+    static constexpr bool from_be_bytes(const uint8_t *bytes, size_t len, uint256 &out) {
+        if (len > 32) {
+            return false;
+        }
+        out = uint256();
+        out.readBE(bytes, len);
+        return true;
+    }
+
+    constexpr bool is_zero() const { return (w[0] | w[1] | w[2] | w[3]) == 0; }
+
+    explicit constexpr operator bool() const { return !is_zero(); }
+
+    // significant bits, 0 for zero
+    constexpr uint32_t bits() const {
+        for (size_t i = 0; i < WORDS; i++) {
+            if (w[i] != 0) {
+                return (uint32_t) ((WORDS - i) * 64 - clz64(w[i]));
+            }
+        }
+        return 0;
+    }
+
+    // truncated to the low 64 bits
+    explicit constexpr operator uint64_t() const { return w[3]; }
+
+    ////// comparison
+
+    friend constexpr bool operator==(const uint256 &a, const uint256 &b) {
+        return a.w[0] == b.w[0] && a.w[1] == b.w[1] && a.w[2] == b.w[2] && a.w[3] == b.w[3];
+    }
+
+    friend constexpr bool operator!=(const uint256 &a, const uint256 &b) { return !(a == b); }
+
+    friend constexpr bool operator<(const uint256 &a, const uint256 &b) {
+        for (size_t i = 0; i < WORDS; i++) {
+            if (a.w[i] != b.w[i]) {
+                return a.w[i] < b.w[i];
+            }
+        }
+        return false;
+    }
+
+    friend constexpr bool operator>(const uint256 &a, const uint256 &b) { return b < a; }
+
+    friend constexpr bool operator<=(const uint256 &a, const uint256 &b) { return !(b < a); }
+
+    friend constexpr bool operator>=(const uint256 &a, const uint256 &b) { return !(a < b); }
+
+    ////// bitwise
+
+    constexpr uint256 operator~() const {
+        uint256 r;
+        for (size_t i = 0; i < WORDS; i++) {
+            r.w[i] = ~w[i];
+        }
+        return r;
+    }
+
+    constexpr uint256 &operator&=(const uint256 &o) {
+        for (size_t i = 0; i < WORDS; i++) {
+            w[i] &= o.w[i];
+        }
+        return *this;
+    }
+
+    constexpr uint256 &operator|=(const uint256 &o) {
+        for (size_t i = 0; i < WORDS; i++) {
+            w[i] |= o.w[i];
+        }
+        return *this;
+    }
+
+    constexpr uint256 &operator^=(const uint256 &o) {
+        for (size_t i = 0; i < WORDS; i++) {
+            w[i] ^= o.w[i];
+        }
+        return *this;
+    }
+
+    // shifts of 256 bits or more give zero
+    constexpr uint256 &operator<<=(uint32_t n) {
+        if (n >= 256) {
+            return *this = uint256();
+        }
+        const size_t words = n / 64;
+        const uint32_t bitsLeft = n % 64;
+        for (size_t i = 0; i < WORDS; i++) {
+            const size_t src = i + words;
+            uint64_t v = 0;
+            if (src < WORDS) {
+                v = w[src] << bitsLeft;
+                if (bitsLeft != 0 && src + 1 < WORDS) {
+                    v |= w[src + 1] >> (64 - bitsLeft);
+                }
+            }
+            w[i] = v;
+        }
+        return *this;
+    }
+
+    constexpr uint256 &operator>>=(uint32_t n) {
+        if (n >= 256) {
+            return *this = uint256();
+        }
+        const size_t words = n / 64;
+        const uint32_t bitsRight = n % 64;
+        for (size_t i = WORDS; i-- > 0;) {
+            uint64_t v = 0;
+            if (i >= words) {
+                const size_t src = i - words;
+                v = w[src] >> bitsRight;
+                if (bitsRight != 0 && src > 0) {
+                    v |= w[src - 1] << (64 - bitsRight);
+                }
+            }
+            w[i] = v;
+        }
+        return *this;
+    }
+
+    ////// arithmetic, modulo 2^256 like the C functions
+
+    constexpr uint256 &operator+=(const uint256 &o) {
+        uint64_t carry = 0;
+        for (size_t i = WORDS; i-- > 0;) {
+            const uint64_t s = w[i] + o.w[i];
+            const uint64_t c1 = s < w[i];
+            w[i] = s + carry;
+            carry = c1 | (w[i] < s);
+        }
+        return *this;
+    }
+
+    constexpr uint256 &operator-=(const uint256 &o) {
+        uint64_t borrow = 0;
+        for (size_t i = WORDS; i-- > 0;) {
+            const uint64_t d = w[i] - o.w[i];
+            const uint64_t b1 = w[i] < o.w[i];
+            const uint64_t r = d - borrow;
+            borrow = b1 | (d < borrow);
+            w[i] = r;
+        }
+        return *this;
+    }
+
+    constexpr uint256 &operator*=(const uint256 &o) {
+        uint256 r;
+        // schoolbook on 64-bit words, keeping only the low 256 bits
+        for (size_t i = 0; i < WORDS; i++) {
+            const uint64_t a = w[WORDS - 1 - i];
+            if (a == 0) {
+                continue;
+            }
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < WORDS; j++) {
+                const size_t k = WORDS - 1 - (i + j);
+                uint64_t hi = 0;
+                uint64_t lo = 0;
+                mul64(a, o.w[WORDS - 1 - j], hi, lo);
+                lo += carry;
+                hi += lo < carry;
+                r.w[k] += lo;
+                hi += r.w[k] < lo;
+                carry = hi;
+            }
+        }
+        return *this = r;
+    }
+
+    // Division by zero throws, which makes it a compile error in a constant expression
+    constexpr uint256 &operator/=(const uint256 &o) {
+        uint256 rem;
+        divmod(*this, o, *this, rem);
+        return *this;
+    }
+
+    constexpr uint256 &operator%=(const uint256 &o) {
+        uint256 quot;
+        divmod(*this, o, quot, *this);
+        return *this;
+    }
+
+    constexpr uint256 &operator++() { return *this += uint256(1); }
+
+    constexpr uint256 &operator--() { return *this -= uint256(1); }
+
+    friend constexpr uint256 operator+(uint256 a, const uint256 &b) { return a += b; }
+
+    friend constexpr uint256 operator-(uint256 a, const uint256 &b) { return a -= b; }
+
+    friend constexpr uint256 operator*(uint256 a, const uint256 &b) { return a *= b; }
+
+    friend constexpr uint256 operator/(uint256 a, const uint256 &b) { return a /= b; }
+
+    friend constexpr uint256 operator%(uint256 a, const uint256 &b) { return a %= b; }
+
+    friend constexpr uint256 operator&(uint256 a, const uint256 &b) { return a &= b; }
+
+    friend constexpr uint256 operator|(uint256 a, const uint256 &b) { return a |= b; }
+
+    friend constexpr uint256 operator^(uint256 a, const uint256 &b) { return a ^= b; }
+
+    friend constexpr uint256 operator<<(uint256 a, uint32_t n) { return a <<= n; }
+
+    friend constexpr uint256 operator>>(uint256 a, uint32_t n) { return a >>= n; }
+
+    static constexpr void divmod(const uint256 &l, const uint256 &r, uint256 &quot, uint256 &rem) {
+        if (r.is_zero()) {
+            throw std::domain_error("uint256 division by zero");
+        }
+        uint256 q;
+        uint256 m;
+        if (r.w[0] == 0 && r.w[1] == 0 && r.w[2] == 0 && r.w[3] <= UINT32_MAX) {
+            m = uint256(divSmall(l, (uint32_t) r.w[3], q));
+        } else {
+            // bit by bit, starting from the most significant bit of l
+            for (uint32_t i = l.bits(); i-- > 0;) {
+                m <<= 1;
+                m.w[WORDS - 1] |= (l.w[WORDS - 1 - i / 64] >> (i % 64)) & 1;
+                if (m >= r) {
+                    m -= r;
+                    q.w[WORDS - 1 - i / 64] |= (uint64_t) 1 << (i % 64);
+                }
+            }
+        }
+        quot = q;
+        rem = m;
+    }
+
+    static constexpr uint256 pow(uint256 base, uint32_t exp) {
+        uint256 r(1);
+        while (exp != 0) {
+            if (exp & 1) {
+                r *= base;
+            }
+            base *= base;
+            exp >>= 1;
+        }
+        return r;
+    }
+
+    ////// formatting, same output as tostring256 with bases 10 and 16
+
+    constexpr decimal_string to_decimal() const {
+        char digits[MAX_DECIMAL_DIGITS] = {};
+        size_t pos = MAX_DECIMAL_DIGITS;
+        uint256 v = *this;
+
+        // nine digits per division
+        do {
+            uint256 q;
+            uint32_t chunk = divSmall(v, 1000000000u, q);
+            v = q;
+            for (uint8_t i = 0; i < 9 && pos > 0; i++) {
+                digits[--pos] = (char) ('0' + chunk % 10);
+                chunk /= 10;
+            }
+        } while (!v.is_zero());
+
+        // drop the leading zeros of the last chunk, keeping at least one digit
+        while (pos < MAX_DECIMAL_DIGITS - 1 && digits[pos] == '0') {
+            pos++;
+        }
+
+        decimal_string out{};
+        for (size_t i = pos; i < MAX_DECIMAL_DIGITS; i++) {
+            out[i - pos] = digits[i];
+        }
+        return out;
+    }
+
+    constexpr hex_string to_hex() const {
+        constexpr char HEXDIGITS[] = "0123456789abcdef";
+        hex_string out{};
+        size_t len = 0;
+        const uint32_t nibbles = bits() == 0 ? 1 : (bits() + 3) / 4;
+        for (uint32_t i = nibbles; i-- > 0;) {
+            out[len++] = HEXDIGITS[(w[WORDS - 1 - i / 16] >> ((i % 16) * 4)) & 0xF];
+        }
+        return out;
+    }
+
+private:
+    uint64_t w[WORDS];
+
+    constexpr void readBE(const uint8_t *bytes, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            const size_t bytePos = len - 1 - i;       // counted from the least significant byte
+            w[WORDS - 1 - bytePos / 8] |= (uint64_t) bytes[i] << ((bytePos % 8) * 8);
+        }
+    }
+
+    static constexpr uint32_t clz64(uint64_t v) {
+        uint32_t n = 0;
+        for (uint64_t mask = (uint64_t) 1 << 63; mask != 0 && (v & mask) == 0; mask >>= 1) {
+            n++;
+        }
+        return n;
+    }
+
+    static constexpr void mul64(uint64_t a, uint64_t b, uint64_t &hi, uint64_t &lo) {
+#if defined(__SIZEOF_INT128__)
+        __extension__ typedef unsigned __int128 u128;
+        const u128 p = (u128) a * b;
+        hi = (uint64_t) (p >> 64);
+        lo = (uint64_t) p;
+#else
+        const uint64_t aLo = (uint32_t) a;
+        const uint64_t aHi = a >> 32;
+        const uint64_t bLo = (uint32_t) b;
+        const uint64_t bHi = b >> 32;
+        const uint64_t ll = aLo * bLo;
+        const uint64_t lh = aLo * bHi;
+        const uint64_t hl = aHi * bLo;
+        const uint64_t mid = (ll >> 32) + (uint32_t) lh + (uint32_t) hl;
+        lo = (mid << 32) | (uint32_t) ll;
+        hi = aHi * bHi + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+    }
+
+    // l / d on 32-bit limbs, for divisors that fit in 32 bits. Returns the remainder
+    static constexpr uint32_t divSmall(const uint256 &l, uint32_t d, uint256 &quot) {
+        uint64_t rem = 0;
+        quot = uint256();
+        for (size_t i = 0; i < WORDS * 2; i++) {
+            const size_t wordIdx = i / 2;
+            const uint32_t shift = (i % 2) ? 0 : 32;
+            const uint64_t cur = (rem << 32) | ((l.w[wordIdx] >> shift) & 0xFFFFFFFFu);
+            quot.w[wordIdx] |= (cur / d) << shift;
+            rem = cur % d;
+        }
+        return (uint32_t) rem;
+    }
+};
+
+static_assert(sizeof(uint256) == sizeof(uint256_t), "uint256 must match the layout of uint256_t");
+static_assert(alignof(uint256) == alignof(uint256_t), "uint256 must match the layout of uint256_t");
+static_assert(std::is_standard_layout<uint256>::value, "uint256 must match the layout of uint256_t");
+static_assert(std::is_trivially_copyable<uint256>::value, "uint256 must match the layout of uint256_t");
+
+namespace detail {
+// compares a formatted value with a literal at compile time
+template<size_t N>
+constexpr bool equals(const std::array<char, N> &s, const char *literal) {
+    for (size_t i = 0; i < N; i++) {
+        if (s[i] != literal[i]) {
+            return false;
+        }
+        if (literal[i] == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+// Known values, checked on every build that includes this header
+static_assert(detail::equals(uint256().to_decimal(), "0"), "uint256 known vector");
+static_assert(detail::equals(uint256().to_hex(), "0"), "uint256 known vector");
+static_assert(detail::equals(uint256::pow(10, 18).to_decimal(), "1000000000000000000"), "uint256 known vector");
+static_assert(detail::equals((~uint256()).to_decimal(),
+                             "115792089237316195423570985008687907853269984665640564039457584007913129639935"),
+              "uint256 known vector");
+static_assert(detail::equals((~uint256()).to_hex(),
+                             "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"),
+              "uint256 known vector");
+static_assert(detail::equals((uint256(1) << 255).to_hex(),
+                             "8000000000000000000000000000000000000000000000000000000000000000"),
+              "uint256 known vector");
+static_assert(uint256() - 1 == ~uint256() && (~uint256() + 1).is_zero(), "uint256 known vector");
+// (2^128 - 1)^2, which carries from the third word into the fourth
+static_assert(detail::equals((((uint256(1) << 128) - 1) * ((uint256(1) << 128) - 1)).to_hex(),
+                             "fffffffffffffffffffffffffffffffe00000000000000000000000000000001"),
+              "uint256 known vector");
+static_assert(detail::equals((~uint256() / uint256::pow(10, 18)).to_decimal(),
+                             "115792089237316195423570985008687907853269984665640564039457"),
+              "uint256 known vector");
+static_assert(detail::equals((~uint256() % uint256::pow(10, 18)).to_decimal(), "584007913129639935"),
+              "uint256 known vector");
+
+}
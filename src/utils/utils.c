@@ -17,363 +17,166 @@
 #include "utils.h"
 #include "stdio.h"
 
-uint8_t hexdigit(uint8_t v) {
-    v &= 0x0F;
-    if (v >= 0x0A) {
-        return 'A' + v - 0x0A;
-    }
-    return '0' + v;
+// Device builds use the table. HEX_PORTABLE forces it on hosts too
+#if !defined(TARGET_NANOS) && !defined(TARGET_NANOX) && !defined(HEX_PORTABLE)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HEX_SIMD_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HEX_SIMD_NEON
+#endif
+#endif
+
+// Two hex digits per byte value
+static const char hexPairs[] =
+        "000102030405060708090A0B0C0D0E0F"
+        "101112131415161718191A1B1C1D1E1F"
+        "202122232425262728292A2B2C2D2E2F"
+        "303132333435363738393A3B3C3D3E3F"
+        "404142434445464748494A4B4C4D4E4F"
+        "505152535455565758595A5B5C5D5E5F"
+        "606162636465666768696A6B6C6D6E6F"
+        "707172737475767778797A7B7C7D7E7F"
+        "808182838485868788898A8B8C8D8E8F"
+        "909192939495969798999A9B9C9D9E9F"
+        "A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+        "B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+        "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+        "D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+        "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+        "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+#if defined(HEX_SIMD_SSE2) || defined(HEX_SIMD_NEON)
+#define HEX_BLOCK 16
+
+// Encodes 16 bytes into 32 chars
+static void hexEncodeBlock(char *out, const uint8_t *in) {
+#if defined(HEX_SIMD_SSE2)
+    const __m128i v = _mm_loadu_si128((const __m128i *) in);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+    const __m128i lo = _mm_and_si128(v, mask);
+    // '0' + n, plus 7 more for A-F
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i seven = _mm_set1_epi8(7);
+    const __m128i hiChars = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), seven));
+    const __m128i loChars = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), seven));
+    _mm_storeu_si128((__m128i *) out, _mm_unpacklo_epi8(hiChars, loChars));
+    _mm_storeu_si128((__m128i *) (out + 16), _mm_unpackhi_epi8(hiChars, loChars));
+#else
+    const uint8x16_t v = vld1q_u8(in);
+    const uint8x16_t hi = vshrq_n_u8(v, 4);
+    const uint8x16_t lo = vandq_u8(v, vdupq_n_u8(0x0F));
+    const uint8x16_t nine = vdupq_n_u8(9);
+    const uint8x16_t zero = vdupq_n_u8('0');
+    const uint8x16_t seven = vdupq_n_u8(7);
+    uint8x16x2_t chars;
+    chars.val[0] = vaddq_u8(vaddq_u8(hi, zero), vandq_u8(vcgtq_u8(hi, nine), seven));
+    chars.val[1] = vaddq_u8(vaddq_u8(lo, zero), vandq_u8(vcgtq_u8(lo, nine), seven));
+    vst2q_u8((uint8_t *) out, chars);
+#endif
 }
+#endif
 
-// Converts data bytes into a hexstring !! IN PLACE !!
-uint8_t convertToHexstringInPlace(uint8_t *data, uint16_t dataLen, uint16_t dataLenMax) {
-    if (dataLen == 0) {
+int8_t hexEncode(char *out, uint16_t outLen, const uint8_t *in, uint16_t inLen) {
+    if ((uint32_t) outLen < 2u * inLen + 1) {
         return UTILS_NOT_ENOUGH_DATA;
     }
 
-    if (dataLenMax < dataLen * 2 + 1) {
-        return UTILS_NOT_ENOUGH_DATA;
+    // Bytes are encoded from the end: byte i only overwrites bytes 2i and 2i + 1,
+    // which have been encoded already when out and in start at the same address
+    out[2 * inLen] = 0;
+
+    uint16_t i = inLen;
+#if defined(HEX_SIMD_SSE2) || defined(HEX_SIMD_NEON)
+    const uint16_t blocksEnd = inLen - inLen % HEX_BLOCK;
+    while (i > blocksEnd) {
+        i--;
+        const char *pair = hexPairs + 2 * in[i];
+        out[2 * i] = pair[0];
+        out[2 * i + 1] = pair[1];
     }
-
-    // clear all empty space so string is terminated
-    MEMSET(data + dataLen, 0, dataLenMax - dataLen);
-
-    for (int i = 0; i < dataLen; i++) {
-        const uint8_t p = (dataLen - i - 1);
-        const uint8_t q = p << 1u;
-
-        data[q] = hexdigit(data[p] >> 4);
-        data[q + 1] = hexdigit(data[p] & 0x0F);
+    while (i > 0) {
+        i -= HEX_BLOCK;
+        hexEncodeBlock(out + 2 * i, in + i);
     }
+#else
+    const char *pairs = (const char *) PIC(hexPairs);
+    while (i > 0) {
+        i--;
+        const char *pair = pairs + 2 * in[i];
+        out[2 * i] = pair[0];
+        out[2 * i + 1] = pair[1];
+    }
+#endif
 
     return UTILS_NOERROR;
 }
 
-//const char *monthName[] = {
-//    "Jan",
-//    "Feb",
-//    "Mar",
-//    "Apr",
-//    "May",
-//    "Jun",
-//    "Jul",
-//    "Aug",
-//    "Set",
-//    "Oct",
-//    "Nov",
-//    "Dec"
-//};
-
-const uint8_t monthDays[] = {
-    31,
-    28,
-    31,
-    30,
-    31,
-    30,
-    31,
-    31,
-    30,
-    31,
-    30,
-    31
-};
-
-const uint32_t yearLookup[] = {
-    0,
-    365,
-    730,
-    1096,
-    1461,
-    1826,
-    2191,
-    2557,
-    2922,
-    3287,
-    3652,
-    4018,
-    4383,
-    4748,
-    5113,
-    5479,
-    5844,
-    6209,
-    6574,
-    6940,
-    7305,
-    7670,
-    8035,
-    8401,
-    8766,
-    9131,
-    9496,
-    9862,
-    10227,
-    10592,
-    10957,
-    11323,
-    11688,
-    12053,
-    12418,
-    12783,
-    13149,
-    13514,
-    13879,
-    14244,
-    14610,
-    14975,
-    15340,
-    15705,
-    16071,
-    16436,
-    16801,
-    17166,
-    17532,
-    17897,
-    18262,
-    18627,
-    18993,
-    19358,
-    19723,
-    20088,
-    20454,
-    20819,
-    21184,
-    21549,
-    21915,
-    22280,
-    22645,
-    23010,
-    23376,
-    23741,
-    24106,
-    24471,
-    24836,
-    25202,
-    25567,
-    25932,
-    26297,
-    26663,
-    27028,
-    27393,
-    27758,
-    28124,
-    28489,
-    28854,
-    29219,
-    29585,
-    29950,
-    30315,
-    30680,
-    31046,
-    31411,
-    31776,
-    32141,
-    32507,
-    32872,
-    33237,
-    33602,
-    33968,
-    34333,
-    34698,
-    35063,
-    35429,
-    35794,
-    36159,
-    36524,
-    36889,
-    37255,
-    37620,
-    37985,
-    38350,
-    38716,
-    39081,
-    39446,
-    39811,
-    40177,
-    40542,
-    40907,
-    41272,
-    41638,
-    42003,
-    42368,
-    42733,
-    43099,
-    43464,
-    43829,
-    44194,
-    44560,
-    44925,
-    45290,
-    45655,
-    46021,
-    46386,
-    46751,
-    47116,
-    47482,
-    47847,
-    48212,
-    48577,
-    48942,
-    49308,
-    49673,
-    50038,
-    50403,
-    50769,
-    51134,
-    51499,
-    51864,
-    52230,
-    52595,
-    52960,
-    53325,
-    53691,
-    54056,
-    54421,
-    54786,
-    55152,
-    55517,
-    55882,
-    56247,
-    56613,
-    56978,
-    57343,
-    57708,
-    58074,
-    58439,
-    58804,
-    59169,
-    59535,
-    59900,
-    60265,
-    60630,
-    60995,
-    61361,
-    61726,
-    62091,
-    62456,
-    62822,
-    63187,
-    63552,
-    63917,
-    64283,
-    64648,
-    65013,
-    65378,
-    65744,
-    66109,
-    66474,
-    66839,
-    67205,
-    67570,
-    67935,
-    68300,
-    68666,
-    69031,
-    69396,
-    69761,
-    70127,
-    70492,
-    70857,
-    71222,
-    71588,
-    71953,
-    72318,
-    72683
-};
+static const char monthNames[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+typedef struct {
+    uint64_t year;
+    uint8_t month;      // 1..12
+    uint8_t day;        // 1..31
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+} civil_time_t;
+
+// ARM does not implement gmtime. This is a closed-form conversion from days to the
+// civil calendar, with years starting on March 1st so that leap days come last
+// http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+// Every step is non-negative, so the whole uint64_t range is covered
+static void toCivilTime(uint64_t t, civil_time_t *c) {
+    uint32_t secs = t % 86400;
+    c->sec = secs % 60;
+    secs /= 60;
+    c->min = secs % 60;
+    c->hour = secs / 60;
+
+    const uint64_t z = t / 86400 + 719468;                                      // days since 0000-03-01
+    const uint64_t era = z / 146097;                                            // 400 year cycles
+    const uint32_t doe = z - era * 146097;                                      // [0, 146096]
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);               // [0, 365]
+    const uint32_t mp = (5 * doy + 2) / 153;                                    // [0, 11], March is 0
+
+    c->day = doy - (153 * mp + 2) / 5 + 1;
+    c->month = mp < 10 ? mp + 3 : mp - 9;
+    c->year = era * 400 + yoe + (c->month <= 2 ? 1 : 0);
+}
 
-// ARM does not implement gmtime. This is a simple alternative implementation
-// based on section 4.16
-// https://pubs.opengroup.org/onlinepubs/9699919799/basedefs/V1_chap04.html
 void printTime(char *out, uint16_t outLen, uint64_t t) {
-    uint8_t tm_sec = 0;
-    uint8_t tm_min = 0;
-    uint8_t tm_hour = 0;
-    uint8_t tm_day = 0;
-    uint8_t tm_mon = 0;
-    uint16_t tm_year = 0;
-
-    tm_sec = t % 60;
-    t -= tm_sec;
-    t /= 60;
-
-    tm_min = t % 60;
-    t -= tm_min;
-    t /= 60;
-
-    tm_hour = t % 24;
-    t -= tm_hour;
-    t /= 24;
+    printTimeFormat(out, outLen, t, TIME_FORMAT_DEFAULT);
+}
 
-    // Look up tm_year
-    tm_year = 0;
-    while (tm_year < 200 && yearLookup[tm_year] < t) tm_year++;
-    tm_year--;
-    tm_day = t - yearLookup[tm_year] + 1;
-    tm_year = 1970 + tm_year;
+void printTimeFormat(char *out, uint16_t outLen, uint64_t t, uint8_t format) {
+    civil_time_t c;
+    toCivilTime(t, &c);
 
-    // Get day/month
-    uint8_t leap = (tm_year % 4 == 0 && (tm_year % 100 != 0 || tm_year % 400 == 0) ? 1 : 0);
+    // years go beyond int, print them separately
+    char year[21];
+    uint64_to_str(year, sizeof(year), c.year);
 
-    for (tm_mon = 0; tm_mon < 12; tm_mon++) {
-        uint8_t tmp = monthDays[tm_mon];
-        tmp += (tm_mon == 1 ? leap : 0);
-        if (tm_day <= tmp) {
-            break;
-        }
-        tm_day -= tmp;
+    if (format == TIME_FORMAT_ISO8601) {
+        // YYYY-MM-DDTHH:MM:SSZ
+        snprintf(out, outLen, "%s-%02d-%02dT%02d:%02d:%02dZ",
+                 year, c.month, c.day,
+                 c.hour, c.min, c.sec);
+        return;
     }
-    tm_mon++;
 
-    char *monthName;
-    switch (tm_mon) {
-        case 1:
-            monthName = "Jan";
-            break;
-        case 2:
-            monthName = "Feb";
-            break;
-        case 3:
-            monthName = "Mar";
-            break;
-        case 4:
-            monthName = "Apr";
-            break;
-        case 5:
-            monthName = "May";
-            break;
-        case 6:
-            monthName = "Jun";
-            break;
-        case 7:
-            monthName = "Jul";
-            break;
-        case 8:
-            monthName = "Aug";
-            break;
-        case 9:
-            monthName = "Sep";
-            break;
-        case 10:
-            monthName = "Oct";
-            break;
-        case 11:
-            monthName = "Nov";
-            break;
-        case 12:
-            monthName = "Dec";
-            break;
-        default:
-            monthName = "ERR";
-    }
+    char monthName[4];
+    MEMCPY(monthName, (const char *) PIC(monthNames) + 3 * (c.month - 1), 3);
+    monthName[3] = 0;
 
-    // YYYYmmdd HH:MM:SS
-    snprintf(out, outLen, "%02d%s%04d %02d:%02d:%02d",
-             tm_day,
-             monthName,
-             tm_year,
-             tm_hour, tm_min, tm_sec
-    );
+    // ddMonYYYY HH:MM:SS
+    snprintf(out, outLen, "%02d%s%s %02d:%02d:%02d",
+             c.day, monthName, year,
+             c.hour, c.min, c.sec);
 }
 
 // automatically generated LUT
@@ -395,10 +198,13 @@ const uint8_t crc8_poly7[] = {
         26, 29, 20, 19, 174, 169, 160, 167, 178, 181, 188, 187, 150, 145, 152, 159, 138, 141, 132, 131, 222, 217, 208,
         215, 194, 197, 204, 203, 230, 225, 232, 239, 250, 253, 244, 243};
 
-uint8_t crc8(const uint8_t *data, size_t data_len) {
-    uint8_t crc = crc8_init;
+uint8_t crc8_update(uint8_t crc, const uint8_t *data, size_t data_len) {
     for (size_t i = 0; i < data_len; i++) {
         crc = crc8_poly7[crc ^ data[i]];
     }
-    return crc ^ crc8_xor_out;
+    return crc;
+}
+
+uint8_t crc8(const uint8_t *data, size_t data_len) {
+    return crc8_update(crc8_init, data, data_len) ^ crc8_xor_out;
 }
@@ -25,13 +25,24 @@ extern "C" {
 #define UTILS_NOERROR 0
 #define UTILS_NOT_ENOUGH_DATA -1
 
-// Converts data bytes into a hexstring !! IN PLACE !!
-uint8_t convertToHexstringInPlace(uint8_t *data, uint16_t dataLen, uint16_t dataLenMax);
+// Encodes inLen bytes as an uppercase zero-terminated hexstring. out needs 2 * inLen + 1 bytes
+// out may start at the same address as in, to convert in place
+// Returns UTILS_NOERROR or UTILS_NOT_ENOUGH_DATA
+int8_t hexEncode(char *out, uint16_t outLen, const uint8_t *in, uint16_t inLen);
 
+#define TIME_FORMAT_DEFAULT 0      // 01Jan2019 00:00:00
+#define TIME_FORMAT_ISO8601 1      // 2019-01-01T00:00:00Z
+
+// Prints a unix time (UTC). Any uint64_t is accepted
 void printTime(char *out, uint16_t outLen, uint64_t t);
 
+void printTimeFormat(char *out, uint16_t outLen, uint64_t t, uint8_t format);
+
 uint8_t crc8(const uint8_t *data, size_t data_len);
 
+// Continues a crc8 over more data. crc8(data) == crc8_update(0, data) as there is no final xor
+uint8_t crc8_update(uint8_t crc, const uint8_t *data, size_t data_len);
+
 #ifdef __cplusplus
 }
 #endif
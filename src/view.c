@@ -31,6 +31,7 @@
 #include <stdio.h>
 
 view_t viewdata;
+view_cache_t viewcache;
 
 void h_address_accept(unsigned int _) {
     UNUSED(_);
@@ -73,6 +74,7 @@ void h_sign_reject(unsigned int _) {
 }
 
 void h_review_init() {
+    viewcache.idx = -1;
     viewdata.idx = 0;
     viewdata.pageIdx = 0;
     viewdata.pageCount = 1;
@@ -94,14 +96,86 @@ void h_review_decrease() {
     }
 }
 
+// Keeps every page of the item in the cache, so moving between its pages does not go through the parser again
+// Page 0 has just been rendered into viewdata. Nothing else is rendered if the item does not fit
+static void h_review_cache_item(int16_t idx) {
+    viewcache.idx = idx;
+    viewcache.cached = 0;
+    viewcache.pageCount = viewdata.pageCount;
+
+    // items without pages are skipped by the review
+    if (viewcache.pageCount == 0) {
+        return;
+    }
+
+    viewcache.pageLen = strlen(viewdata.value);
+
+    // page p is rendered right after page p-1, so it overwrites its terminator
+    if ((viewcache.pageCount - 1) * viewcache.pageLen + MAX_CHARS_PER_VALUE1_LINE > MAX_CHARS_CACHED_VALUE) {
+        return;
+    }
+
+    MEMCPY(viewcache.key, viewdata.key, MAX_CHARS_PER_KEY_LINE);
+    MEMCPY(viewcache.value, viewdata.value, viewcache.pageLen + 1);
+
+    uint8_t pageCount;
+    for (uint8_t p = 1; p < viewcache.pageCount; p++) {
+        // the parser reports the error again when the page is shown
+        if (tx_getItem(idx,
+                       viewcache.key, MAX_CHARS_PER_KEY_LINE,
+                       viewcache.value + p * viewcache.pageLen, MAX_CHARS_PER_VALUE1_LINE,
+                       p, &pageCount) != tx_no_error) {
+            return;
+        }
+    }
+
+    // values with embedded zeros cannot be sliced
+    viewcache.valueLen = strlen(viewcache.value);
+    if (viewcache.pageCount > 1 && viewcache.valueLen <= (viewcache.pageCount - 1) * viewcache.pageLen) {
+        return;
+    }
+
+    viewcache.cached = 1;
+}
+
+static tx_error_t h_review_get_item() {
+    const uint8_t newItem = viewcache.idx != viewdata.idx;
+
+    if (newItem || !viewcache.cached || viewdata.pageIdx >= viewcache.pageCount) {
+        // not cached (yet), or let the parser report the bad page
+        tx_error_t err = tx_getItem(viewdata.idx,
+                                    viewdata.key, MAX_CHARS_PER_KEY_LINE,
+                                    viewdata.value, MAX_CHARS_PER_VALUE1_LINE,
+                                    viewdata.pageIdx, &viewdata.pageCount);
+        // pages are laid out from the first one
+        if (err == tx_no_error && newItem && viewdata.pageIdx == 0) {
+            h_review_cache_item(viewdata.idx);
+        }
+        return err;
+    }
+
+    MEMCPY(viewdata.key, viewcache.key, MAX_CHARS_PER_KEY_LINE);
+    viewdata.pageCount = viewcache.pageCount;
+
+    uint16_t offset = viewdata.pageIdx * viewcache.pageLen;
+    uint16_t len = 0;
+    if (offset < viewcache.valueLen) {
+        len = viewcache.valueLen - offset;
+        if (len > viewcache.pageLen) {
+            len = viewcache.pageLen;
+        }
+    }
+    MEMCPY(viewdata.value, viewcache.value + offset, len);
+    viewdata.value[len] = 0;
+
+    return tx_no_error;
+}
+
 view_error_t h_review_update_data() {
     tx_error_t err = tx_no_error;
 
     do {
-        err = tx_getItem(viewdata.idx,
-                         viewdata.key, MAX_CHARS_PER_KEY_LINE,
-                         viewdata.value, MAX_CHARS_PER_VALUE1_LINE,
-                         viewdata.pageIdx, &viewdata.pageCount);
+        err = h_review_get_item();
 
         if (err == tx_no_data) {
             return view_no_data;
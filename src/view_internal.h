@@ -41,6 +41,15 @@
 #endif
 #define MAX_CHARS_ADDR              (MAX_CHARS_PER_KEY_LINE + MAX_CHARS_PER_VALUE1_LINE)
 
+// Formatted value of the item under review, up to MAX_PAGES_CACHED pages.
+// Items that do not fit are rendered page by page. A Nano X page is already a whole value line
+#if defined(TARGET_NANOX)
+#define MAX_PAGES_CACHED            1
+#else
+#define MAX_PAGES_CACHED            3
+#endif
+#define MAX_CHARS_CACHED_VALUE      (MAX_PAGES_CACHED*(MAX_CHARS_PER_VALUE1_LINE-1)+1)
+
 // This typically will point to G_io_apdu_buffer that is prefilled with the address
 
 typedef struct {
@@ -56,13 +65,23 @@ typedef struct {
             char addr[MAX_CHARS_ADDR];
         };
     };
-    int8_t idx;
+    int16_t idx;
     int8_t pageIdx;
     uint8_t pageCount;
 } view_t;
 
 extern view_t viewdata;
 
+typedef struct {
+    char key[MAX_CHARS_PER_KEY_LINE];
+    char value[MAX_CHARS_CACHED_VALUE];
+    int16_t idx;            // -1 when empty
+    uint8_t cached;         // 0 when the item did not fit, pages are then rendered one by one
+    uint8_t pageCount;
+    uint16_t pageLen;       // chars per page, all pages but the last one are full
+    uint16_t valueLen;
+} view_cache_t;
+
 typedef enum {
     view_no_error = 0,
     view_no_data = 1,
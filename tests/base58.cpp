@@ -0,0 +1,82 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utils/base58.h"
+
+namespace {
+
+std::string encode(const std::vector<uint8_t> &in) {
+    unsigned char out[64];
+    size_t outLen = sizeof(out);
+    EXPECT_THAT(encode_base58(in.data(), in.size(), out, &outLen), testing::Eq(0));
+    return std::string((const char *) out, outLen);
+}
+
+std::string encode20(const std::vector<uint8_t> &in) {
+    unsigned char out[64];
+    size_t outLen = sizeof(out);
+    EXPECT_THAT(encode_base58_20(in.data(), out, &outLen), testing::Eq(0));
+    return std::string((const char *) out, outLen);
+}
+
+}
+
+TEST(BASE58, Encode20MatchesEncode) {
+    std::mt19937 rng(5);
+    for (int n = 0; n < 10000; n++) {
+        std::vector<uint8_t> in(20);
+        for (auto &b : in) {
+            b = (uint8_t) rng();
+        }
+        ASSERT_THAT(encode20(in), testing::Eq(encode(in)));
+    }
+}
+
+// Leading zero bytes are encoded one by one, the zero digits after them are not
+TEST(BASE58, Encode20MatchesEncodeWithLeadingZeros) {
+    std::mt19937 rng(6);
+    for (size_t zeros = 0; zeros <= 20; zeros++) {
+        for (int n = 0; n < 100; n++) {
+            std::vector<uint8_t> in(20, 0);
+            for (size_t i = zeros; i < in.size(); i++) {
+                in[i] = (uint8_t) rng();
+            }
+            // small values right after the zeros
+            if (zeros < in.size() && n % 2 == 0) {
+                in[zeros] = 1;
+            }
+            ASSERT_THAT(encode20(in), testing::Eq(encode(in))) << zeros << " zeros";
+        }
+    }
+    ASSERT_THAT(encode20(std::vector<uint8_t>(20, 0)), testing::Eq(std::string(20, '1')));
+    ASSERT_THAT(encode20(std::vector<uint8_t>(20, 0xFF)), testing::Eq(encode(std::vector<uint8_t>(20, 0xFF))));
+}
+
+TEST(BASE58, Encode20ReportsTheSizeNeeded) {
+    const std::vector<uint8_t> in(20, 0xAB);
+    const size_t expected = encode(in).size();
+
+    unsigned char out[64];
+    size_t outLen = expected - 1;
+    ASSERT_THAT(encode_base58_20(in.data(), out, &outLen), testing::Eq(-1));
+    ASSERT_THAT(outLen, testing::Eq(expected));
+}
@@ -0,0 +1,214 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/crypto.h"
+#include "mocks/keccak.h"
+#include "utils/base58.h"
+#include "utils/utils.h"
+
+// defined in crypto.c, not exported by crypto.h
+extern "C" uint8_t message_digest[32];
+
+namespace {
+
+std::string hex(const uint8_t *data, size_t len) {
+    std::string out;
+    char h[3];
+    for (size_t i = 0; i < len; i++) {
+        snprintf(h, sizeof(h), "%02x", data[i]);
+        out += h;
+    }
+    return out;
+}
+
+std::vector<uint8_t> randomEthAddress(std::mt19937 *rng, size_t zeroBytes) {
+    std::vector<uint8_t> ethAddress(20, 0);
+    for (size_t i = zeroBytes; i < ethAddress.size(); i++) {
+        ethAddress[i] = (uint8_t) (*rng)();
+    }
+    // the zero bytes are exactly zeroBytes
+    if (zeroBytes < ethAddress.size() && ethAddress[zeroBytes] == 0) {
+        ethAddress[zeroBytes] = 1;
+    }
+    return ethAddress;
+}
+
+std::string manAddress(std::vector<uint8_t> ethAddress) {
+    char out[64];
+    const uint8_t len = manAddressFromEthAddr(out, ethAddress.data());
+    return std::string(out, len);
+}
+
+// appends the check character of body
+std::string withCrc(const std::string &body) {
+    return body + encode_base58_clip(crc8((const uint8_t *) body.data(), body.size()));
+}
+
+bool validate(const std::string &address) {
+    return manAddressValidate(address.data(), (uint16_t) address.size());
+}
+
+std::string keccak256(const std::vector<uint8_t> &message) {
+    uint8_t digest[32];
+    keccak_hash(digest, sizeof(digest), message.data(), message.size(), 136, 0x01);
+    return hex(digest, sizeof(digest));
+}
+
+}
+
+TEST(CRYPTO, HashOfEmptyMessage) {
+    crypto_hashInit();
+    crypto_hashFinal();
+    ASSERT_THAT(hex(message_digest, sizeof(message_digest)),
+                testing::Eq("c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470"));
+}
+
+// The message arrives in APDUs of any size, the digest does not depend on how it was split
+TEST(CRYPTO, HashChunksMatchOneShot) {
+    std::mt19937 rng(9);
+    // lengths around multiples of the 136 bytes rate
+    for (size_t len : {1, 135, 136, 137, 271, 272, 273, 1000, 4096}) {
+        std::vector<uint8_t> message(len);
+        for (auto &b : message) {
+            b = (uint8_t) rng();
+        }
+        const std::string expected = keccak256(message);
+
+        for (int split = 0; split < 20; split++) {
+            crypto_hashInit();
+            size_t offset = 0;
+            while (offset < len) {
+                // empty chunks too, and single bytes on the first pass
+                const size_t chunk = std::min(len - offset, split == 0 ? 1 : (size_t) (rng() % 300));
+                crypto_hashUpdate(message.data() + offset, (uint16_t) chunk);
+                offset += chunk;
+            }
+            crypto_hashFinal();
+            ASSERT_THAT(hex(message_digest, sizeof(message_digest)), testing::Eq(expected))
+                                << "length " << len << " split " << split;
+        }
+    }
+}
+
+TEST(CRYPTO, ManAddressRoundTrip) {
+    std::mt19937 rng(13);
+    for (size_t zeroBytes = 0; zeroBytes <= 20; zeroBytes++) {
+        for (int n = 0; n < 50; n++) {
+            const auto ethAddress = randomEthAddress(&rng, zeroBytes);
+            const std::string address = manAddress(ethAddress);
+            ASSERT_THAT(address.substr(0, 4), testing::Eq("MAN."));
+            ASSERT_THAT(address.find_first_not_of('1', 4) - 4, testing::Eq(zeroBytes)) << address;
+
+            uint8_t decoded[20];
+            ASSERT_TRUE(manAddressDecode(decoded, address.data(), (uint16_t) address.size())) << address;
+            ASSERT_THAT(std::vector<uint8_t>(decoded, decoded + 20), testing::Eq(ethAddress)) << address;
+            ASSERT_TRUE(validate(address)) << address;
+        }
+    }
+}
+
+TEST(CRYPTO, ManAddressRejectsBadCrc) {
+    std::mt19937 rng(14);
+    const std::string address = manAddress(randomEthAddress(&rng, 0));
+    const std::string body = address.substr(0, address.size() - 1);
+    for (const char *c = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz"; *c != 0; c++) {
+        ASSERT_THAT(validate(body + *c), testing::Eq(body + *c == address)) << body + *c;
+    }
+}
+
+TEST(CRYPTO, ManAddressRejectsWrongPrefix) {
+    std::mt19937 rng(15);
+    const std::string address = manAddress(randomEthAddress(&rng, 0));
+    const std::string payload = address.substr(4, address.size() - 5);
+    for (const std::string prefix : {"MAM.", "man.", "MAN:", "MA.", "MANN.", "", "ETH."}) {
+        // the check character is right for the prefix, only the prefix is wrong
+        ASSERT_FALSE(validate(withCrc(prefix + payload))) << prefix;
+    }
+    ASSERT_TRUE(validate(withCrc("MAN." + payload)));
+}
+
+TEST(CRYPTO, ManAddressRejectsWrongLength) {
+    std::mt19937 rng(16);
+    for (const std::string address : {std::string(), std::string("M"), std::string("MAN."), withCrc("MAN.")}) {
+        ASSERT_FALSE(validate(address)) << address;
+    }
+
+    // a payload over 20 bytes
+    std::vector<uint8_t> ethAddress = randomEthAddress(&rng, 0);
+    ethAddress[0] = 0xFF;
+    const std::string address = manAddress(ethAddress);
+    const std::string body = address.substr(0, address.size() - 1);
+    ASSERT_TRUE(validate(address));
+    ASSERT_FALSE(validate(withCrc(body + "1")));
+    ASSERT_FALSE(validate(withCrc(body + "z")));
+
+    // a cut address does not keep its check character
+    for (size_t len = 0; len < address.size(); len++) {
+        ASSERT_FALSE(validate(address.substr(0, len))) << address.substr(0, len);
+    }
+}
+
+TEST(CRYPTO, ManAddressRejectsBadCharacters) {
+    std::mt19937 rng(17);
+    const std::string address = manAddress(randomEthAddress(&rng, 0));
+    const std::string body = address.substr(0, address.size() - 1);
+    for (const char c : {'0', 'O', 'I', 'l', '+', ' ', '\0'}) {
+        std::string bad = body;
+        bad[6] = c;
+        ASSERT_FALSE(validate(withCrc(bad))) << bad;
+    }
+}
+
+// One '1' per leading zero byte: other counts decode to the same bytes but are not canonical
+TEST(CRYPTO, ManAddressRejectsNonCanonicalLeadingOnes) {
+    std::mt19937 rng(18);
+    for (size_t zeroBytes = 0; zeroBytes < 20; zeroBytes++) {
+        const std::string address = manAddress(randomEthAddress(&rng, zeroBytes));
+        const std::string body = address.substr(0, address.size() - 1);
+        ASSERT_TRUE(validate(address)) << address;
+
+        ASSERT_FALSE(validate(withCrc("MAN.1" + body.substr(4)))) << address;
+        if (zeroBytes > 0) {
+            ASSERT_FALSE(validate(withCrc("MAN." + body.substr(5)))) << address;
+        }
+    }
+}
+
+TEST(CRYPTO, ManAddressValidateBatch) {
+    std::mt19937 rng(19);
+    const std::string good0 = manAddress(randomEthAddress(&rng, 0));
+    const std::string good1 = manAddress(randomEthAddress(&rng, 3));
+    const std::string badCrc = good0.substr(0, good0.size() - 1) + (good0.back() == '2' ? '3' : '2');
+    const std::string badPrefix = withCrc("MAM." + good1.substr(4, good1.size() - 5));
+    const std::vector<std::string> addresses = {good0, badCrc, good1, badPrefix, ""};
+
+    std::vector<const char *> pointers;
+    std::vector<uint16_t> lens;
+    for (const auto &a : addresses) {
+        pointers.push_back(a.data());
+        lens.push_back((uint16_t) a.size());
+    }
+    std::vector<uint8_t> valid(addresses.size(), 0xAA);
+    ASSERT_THAT(manAddressValidateBatch(pointers.data(), lens.data(), addresses.size(), valid.data()),
+                testing::Eq(2u));
+    ASSERT_THAT(valid, testing::ElementsAre(1, 0, 1, 0, 0));
+}
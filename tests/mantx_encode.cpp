@@ -0,0 +1,192 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "lib/mantx_encode.h"
+#include "lib/parser.h"
+#include "lib/parser_impl.h"
+
+namespace {
+
+std::string bytesOf(const uint8_t *buffer, const rlp_field_t *f) {
+    uint16_t len = 0;
+    EXPECT_THAT(rlp_readBytesLen(f, &len), testing::Eq(RLP_NO_ERROR));
+    return std::string((const char *) buffer + f->fieldOffset + f->valueOffset, len);
+}
+
+// value of the item with the given title
+std::string itemOf(parser_context_t *ctx, const std::string &key) {
+    char k[64];
+    char v[64];
+    uint8_t pageCount;
+    for (int16_t i = 0; i < parser_getNumItems(ctx); i++) {
+        if (parser_getItem(ctx, i, k, sizeof(k), v, sizeof(v), 0, &pageCount) == parser_ok && key == k) {
+            return v;
+        }
+    }
+    return "";
+}
+
+uint64_t uint64Of(const uint8_t *buffer, const rlp_field_t *f) {
+    uint64_t v = 0;
+    EXPECT_THAT(rlp_readUInt64(buffer, f, &v), testing::Eq(RLP_NO_ERROR));
+    return v;
+}
+
+bool sameUInt256(const uint8_t *buffer, const rlp_field_t *f, uint256_t expected) {
+    uint256_t v;
+    return rlp_readUInt256(buffer, f, &v) == RLP_NO_ERROR && equal256(&v, &expected);
+}
+
+}
+
+// Whatever mantx_encode writes is read back by the parser with the same values
+TEST(MANTX_ENCODE, RoundTrip) {
+    const std::string to = "MAN.3uK6bsVd5q2uw6zTZfFhZWVf3Z4oM";
+    const std::string to0 = "MAN.2skMrkoEkie1UhQ8gf2tMbP3Q7gJ";
+    const std::string to1 = "MAN.4BRmmxsC9iPPDyr8CRpRKUcp7GAww";
+    const std::vector<uint8_t> data = {0x00, 0x01, 0xAB, 0xFF};
+    const std::vector<uint8_t> payload1 = {0xDE, 0xAD};
+
+    mantx_extrato_t extraTo[2];
+    extraTo[0].to = to0.c_str();
+    extraTo[0].toLen = to0.size();
+    clear256(&extraTo[0].amount);
+    LOWER(LOWER(extraTo[0].amount)) = 3;
+    // an empty payload may come without a buffer
+    extraTo[0].payload = nullptr;
+    extraTo[0].payloadLen = 0;
+    extraTo[1].to = to1.c_str();
+    extraTo[1].toLen = to1.size();
+    clear256(&extraTo[1].amount);
+    UPPER(LOWER(extraTo[1].amount)) = 1;
+    extraTo[1].payload = payload1.data();
+    extraTo[1].payloadLen = payload1.size();
+
+    mantx_t tx;
+    memset(&tx, 0, sizeof(tx));
+    tx.nonce = 0x123456789AULL;
+    LOWER(LOWER(tx.gasPrice)) = 18000000000ULL;
+    LOWER(LOWER(tx.gasLimit)) = 21000;
+    tx.to = to.c_str();
+    tx.toLen = to.size();
+    UPPER(LOWER(tx.value)) = 0x36;
+    LOWER(LOWER(tx.value)) = 0x35C9ADC5DEA00000ULL;
+    tx.data = data.data();
+    tx.dataLen = data.size();
+    tx.v = 3;
+    tx.enterType = 1;
+    tx.isEntrustTx = 1;
+    tx.commitTime = 1546300800;
+    tx.txType = MANTX_TXTYPE_NORMAL;
+    tx.lockHeight = 7;
+    tx.extraTo = extraTo;
+    tx.extraToCount = 2;
+
+    std::vector<uint8_t> buffer(mantx_encodedLen(&tx));
+    uint32_t written = 0;
+    ASSERT_THAT(mantx_encode(&tx, buffer.data(), buffer.size(), &written), testing::Eq(RLP_NO_ERROR));
+    ASSERT_THAT(written, testing::Eq(buffer.size()));
+
+    parser_context_t ctx;
+    parser_tx_t tx_obj;
+    ASSERT_THAT(parser_parse(&ctx, buffer.data(), buffer.size(), &tx_obj), testing::Eq(parser_ok));
+    ASSERT_THAT(parser_validate(&ctx), testing::Eq(parser_ok));
+
+    const uint8_t *b = buffer.data();
+    const rlp_field_t *root = tx_obj.nodes + tx_obj.rootFieldsIdx;
+    EXPECT_THAT(uint64Of(b, root + MANTX_FIELD_NONCE), testing::Eq(tx.nonce));
+    EXPECT_TRUE(sameUInt256(b, root + MANTX_FIELD_GASPRICE, tx.gasPrice));
+    EXPECT_TRUE(sameUInt256(b, root + MANTX_FIELD_GASLIMIT, tx.gasLimit));
+    EXPECT_THAT(bytesOf(b, root + MANTX_FIELD_TO), testing::Eq(to));
+    EXPECT_TRUE(sameUInt256(b, root + MANTX_FIELD_VALUE, tx.value));
+    EXPECT_THAT(bytesOf(b, root + MANTX_FIELD_DATA), testing::Eq(std::string(data.begin(), data.end())));
+    EXPECT_THAT(uint64Of(b, root + MANTX_FIELD_V), testing::Eq(tx.v));
+    EXPECT_THAT(uint64Of(b, root + MANTX_FIELD_R), testing::Eq(0u));
+    EXPECT_THAT(uint64Of(b, root + MANTX_FIELD_S), testing::Eq(0u));
+    EXPECT_THAT(uint64Of(b, root + MANTX_FIELD_ENTERTYPE), testing::Eq(tx.enterType));
+    EXPECT_THAT(uint64Of(b, root + MANTX_FIELD_ISENTRUSTTX), testing::Eq(tx.isEntrustTx));
+    EXPECT_THAT(uint64Of(b, root + MANTX_FIELD_COMMITTIME), testing::Eq(tx.commitTime));
+
+    EXPECT_THAT(tx_obj.extraTxType, testing::Eq(tx.txType));
+    EXPECT_THAT(uint64Of(b, tx_obj.nodes + tx_obj.extraFieldsIdx + 1), testing::Eq(tx.lockHeight));
+
+    ASSERT_THAT(tx_obj.extraToListCount, testing::Eq(tx.extraToCount));
+    for (uint16_t i = 0; i < tx.extraToCount; i++) {
+        rlp_field_t fields[MANTX_EXTRATOFIELD_COUNT];
+        ASSERT_THAT(parser_getExtraTo(&ctx, &tx_obj, i, fields), testing::Eq(parser_ok));
+        EXPECT_THAT(bytesOf(b, fields + 0), testing::Eq(std::string(extraTo[i].to, extraTo[i].toLen)));
+        EXPECT_TRUE(sameUInt256(b, fields + 1, extraTo[i].amount));
+        const std::string payload = extraTo[i].payloadLen > 0
+                                    ? std::string((const char *) extraTo[i].payload, extraTo[i].payloadLen)
+                                    : std::string();
+        EXPECT_THAT(bytesOf(b, fields + 2), testing::Eq(payload));
+    }
+}
+
+// Canonical RLP writes some values in forms that differ from the usual ones:
+// a chain id of 0 is an empty string, 0x80 and above are strings, and a single byte below 0x80 is the byte itself
+TEST(MANTX_ENCODE, RoundTripSingleBytes) {
+    const std::string to = "MAN.3uK6bsVd5q2uw6zTZfFhZWVf3Z4oM";
+    const std::string to0 = "MAN.2skMrkoEkie1UhQ8gf2tMbP3Q7gJ";
+
+    for (const uint8_t v : {0x00, 0x7F, 0x80}) {
+        for (const uint8_t byte : {0x00, 0x7F, 0x80}) {
+            mantx_extrato_t extraTo;
+            extraTo.to = to0.c_str();
+            extraTo.toLen = to0.size();
+            clear256(&extraTo.amount);
+            extraTo.payload = &byte;
+            extraTo.payloadLen = 1;
+
+            mantx_t tx;
+            memset(&tx, 0, sizeof(tx));
+            tx.to = to.c_str();
+            tx.toLen = to.size();
+            tx.data = &byte;
+            tx.dataLen = 1;
+            tx.v = v;
+            tx.txType = MANTX_TXTYPE_NORMAL;
+            tx.extraTo = &extraTo;
+            tx.extraToCount = 1;
+
+            std::vector<uint8_t> buffer(mantx_encodedLen(&tx));
+            uint32_t written = 0;
+            ASSERT_THAT(mantx_encode(&tx, buffer.data(), buffer.size(), &written), testing::Eq(RLP_NO_ERROR));
+
+            parser_context_t ctx;
+            parser_tx_t tx_obj;
+            ASSERT_THAT(parser_parse(&ctx, buffer.data(), buffer.size(), &tx_obj), testing::Eq(parser_ok))
+                                << "v " << (int) v << " byte " << (int) byte;
+            ASSERT_THAT(parser_validate(&ctx), testing::Eq(parser_ok));
+
+            const uint8_t *b = buffer.data();
+            const rlp_field_t *root = tx_obj.nodes + tx_obj.rootFieldsIdx;
+            EXPECT_THAT(uint64Of(b, root + MANTX_FIELD_V), testing::Eq(v));
+            EXPECT_THAT(itemOf(&ctx, "ChainID"), testing::Eq(std::to_string(v)));
+            EXPECT_THAT(bytesOf(b, root + MANTX_FIELD_DATA), testing::Eq(std::string(1, (char) byte)));
+
+            rlp_field_t fields[MANTX_EXTRATOFIELD_COUNT];
+            ASSERT_THAT(parser_getExtraTo(&ctx, &tx_obj, 0, fields), testing::Eq(parser_ok));
+            EXPECT_THAT(bytesOf(b, fields + 2), testing::Eq(std::string(1, (char) byte)));
+        }
+    }
+}
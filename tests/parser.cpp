@@ -0,0 +1,302 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/parser.h"
+#include "tx_builder.h"
+#include "view_internal.h"
+
+namespace {
+
+struct ParsedTx {
+    std::vector<uint8_t> buffer;
+    parser_context_t ctx;
+    parser_tx_t tx_obj;
+
+    explicit ParsedTx(const std::vector<uint8_t> &b) : buffer(b) {}
+
+    parser_error_t parse() {
+        return parser_parse(&ctx, buffer.data(), (uint16_t) buffer.size(), &tx_obj);
+    }
+
+    // index of the item with the given title, or -1
+    int16_t find(const std::string &key) {
+        char k[64];
+        char v[64];
+        uint8_t pageCount;
+        for (int16_t i = 0; i < parser_getNumItems(&ctx); i++) {
+            parser_getItem(&ctx, i, k, sizeof(k), v, sizeof(v), 0, &pageCount);
+            if (key == k) {
+                return i;
+            }
+        }
+        return -1;
+    }
+};
+
+}
+
+TEST(PARSER, JsonMembersCannotSpoofTxFields) {
+    RlpItem tx = sampleTx();
+    tx.items[MANTX_FIELD_DATA] = RlpItem::str(std::string(R"({"To":"MAN.2skMrkoEkie1UhQ8gf2tMbP3Q7gJ","Value":""})"));
+    tx.items[MANTX_FIELD_EXTRA].items[0].items[0] = RlpItem::num(MANTX_TXTYPE_CREATE_CURR);
+
+    ParsedTx p(tx.encode());
+    ASSERT_THAT(p.parse(), testing::Eq(parser_ok));
+
+    // the only items with tx field titles are the tx fields themselves
+    ASSERT_THAT(p.find("Data.To"), testing::Ge(0));
+    ASSERT_THAT(p.find("To"), testing::Lt(p.find("Data.To")));
+    ASSERT_THAT(p.find("Value"), testing::Lt(p.find("Data.To")));
+
+    const int16_t idx = p.find("Data.Value");
+    ASSERT_THAT(idx, testing::Ge(0));
+    char k[64];
+    char v[64];
+    uint8_t pageCount;
+    ASSERT_THAT(parser_getItem(&p.ctx, idx, k, sizeof(k), v, sizeof(v), 0, &pageCount), testing::Eq(parser_ok));
+    ASSERT_THAT(pageCount, testing::Eq(1));
+    ASSERT_THAT(std::string(v), testing::Eq("(empty)"));
+}
+
+TEST(PARSER, CommitTimeWiderThan64Bits) {
+    RlpItem tx = sampleTx();
+    tx.items[MANTX_FIELD_COMMITTIME] = RlpItem::str(std::vector<uint8_t>{1, 2, 3, 4, 5, 6, 7, 8, 9});
+
+    ParsedTx p(tx.encode());
+    ASSERT_THAT(p.parse(), testing::Eq(parser_ok));
+    ASSERT_THAT(std::string(parser_getErrorDescription(parser_validate(&p.ctx))), testing::Eq("Invalid time"));
+
+    const int16_t idx = p.find("CommitTime");
+    ASSERT_THAT(idx, testing::Ge(0));
+    char k[64];
+    char v[64];
+    uint8_t pageCount;
+    const parser_error_t err = parser_getItem(&p.ctx, idx, k, sizeof(k), v, sizeof(v), 0, &pageCount);
+    ASSERT_THAT(std::string(parser_getErrorDescription(err)), testing::Eq("Invalid time"));
+}
+
+TEST(PARSER, NonceWiderThan64Bits) {
+    RlpItem tx = sampleTx();
+    tx.items[MANTX_FIELD_NONCE] = RlpItem::str(std::vector<uint8_t>{1, 2, 3, 4, 5, 6, 7, 8, 9});
+
+    ParsedTx p(tx.encode());
+    ASSERT_THAT(p.parse(), testing::Eq(parser_ok));
+
+    const int16_t idx = p.find("Nonce");
+    ASSERT_THAT(idx, testing::Ge(0));
+    char k[64];
+    char v[64];
+    uint8_t pageCount;
+    // a nonce that does not fit in the value line is rejected instead of being cut
+    const parser_error_t err = parser_getItem(&p.ctx, idx, k, sizeof(k), v, 4, 0, &pageCount);
+    ASSERT_THAT(err, testing::Eq(parser_unexpected_field));
+}
+
+TEST(PARSER, BatchReusesUninitializedTxObj) {
+    RlpItem invalid = sampleTx();
+    invalid.items[MANTX_FIELD_COMMITTIME] = RlpItem::str(std::vector<uint8_t>{1, 2, 3, 4, 5, 6, 7, 8, 9});
+
+    const std::vector<std::vector<uint8_t>> buffers = {sampleTx().encode(), invalid.encode(), sampleTx().encode()};
+    std::vector<const uint8_t *> txs;
+    std::vector<uint16_t> txLens;
+    for (const auto &b : buffers) {
+        txs.push_back(b.data());
+        txLens.push_back((uint16_t) b.size());
+    }
+
+    parser_tx_t tx_obj;
+    memset(&tx_obj, 0xA5, sizeof(tx_obj));
+    uint64_t nonce[3] = {0};
+    parser_error_t error[3];
+    parser_batch_t out = {};
+    out.nonce = nonce;
+    out.error = error;
+
+    ASSERT_THAT(parser_parseBatch(txs.data(), txLens.data(), 0, 3, &tx_obj, &out), testing::Eq(2u));
+    ASSERT_THAT(error[0], testing::Eq(parser_ok));
+    ASSERT_THAT(error[1], testing::Eq(parser_invalid_time));
+    ASSERT_THAT(error[2], testing::Eq(parser_ok));
+    ASSERT_THAT(nonce[0], testing::Eq(12u));
+    ASSERT_THAT(nonce[2], testing::Eq(12u));
+}
+
+// Fields with more pages than the device can show are rejected up front, not halfway through the review
+TEST(PARSER, DataWithTooManyPages) {
+    RlpItem tx = sampleTx();
+    // shown as hex, so 5000 bytes are 10000 chars
+    tx.items[MANTX_FIELD_DATA] = RlpItem::str(std::vector<uint8_t>(5000, 0xAB));
+
+    ParsedTx p(tx.encode());
+    ASSERT_THAT(p.parse(), testing::Eq((parser_error_t) RLP_ERROR_INVALID_PAGE));
+}
+
+TEST(PARSER, ExtraToPayloadWithTooManyPages) {
+    RlpItem tx = sampleTx();
+    tx.items[MANTX_FIELD_EXTRA].items[0].items[2].items[0].items[2] =
+            RlpItem::str(std::vector<uint8_t>(5000, 0xAB));
+
+    ParsedTx p(tx.encode());
+    ASSERT_THAT(p.parse(), testing::Eq(parser_ok));
+    ASSERT_THAT(parser_validate(&p.ctx), testing::Eq((parser_error_t) RLP_ERROR_INVALID_PAGE));
+
+    // rendering reports the same error
+    const int16_t idx = p.find("[0] Payload");
+    ASSERT_THAT(idx, testing::Ge(0));
+    char k[64];
+    // values are rendered in the value line of the device
+    char v[MAX_CHARS_PER_VALUE1_LINE];
+    uint8_t pageCount;
+    ASSERT_THAT(parser_getItem(&p.ctx, idx, k, sizeof(k), v, sizeof(v), 0, &pageCount),
+                testing::Eq((parser_error_t) RLP_ERROR_INVALID_PAGE));
+}
+
+// Canonical RLP encodes a single byte below 0x80 as itself, which is still a string of one byte
+TEST(PARSER, SingleByteStrings) {
+    RlpItem tx = sampleTx();
+    tx.items[MANTX_FIELD_TO] = RlpItem::str("A");
+    tx.items[MANTX_FIELD_DATA] = RlpItem::str(std::vector<uint8_t>{0x05});
+    tx.items[MANTX_FIELD_EXTRA].items[0].items[2].items[0].items[0] = RlpItem::str("B");
+    tx.items[MANTX_FIELD_EXTRA].items[0].items[2].items[0].items[2] = RlpItem::str(std::vector<uint8_t>{0x7F});
+
+    ParsedTx p(tx.encode());
+    ASSERT_THAT(p.parse(), testing::Eq(parser_ok));
+    ASSERT_THAT(parser_validate(&p.ctx), testing::Eq(parser_ok));
+
+    const std::vector<std::pair<std::string, std::string>> expected = {
+            {"To",          "A"},
+            {"Data",        "05"},
+            {"[0] To",      "B"},
+            {"[0] Payload", "7F"},
+    };
+    for (const auto &e : expected) {
+        const int16_t idx = p.find(e.first);
+        ASSERT_THAT(idx, testing::Ge(0)) << e.first;
+        char k[64];
+        char v[MAX_CHARS_PER_VALUE1_LINE];
+        uint8_t pageCount;
+        ASSERT_THAT(parser_getItem(&p.ctx, idx, k, sizeof(k), v, sizeof(v), 0, &pageCount), testing::Eq(parser_ok));
+        ASSERT_THAT(pageCount, testing::Eq(1));
+        ASSERT_THAT(std::string(v), testing::Eq(e.second)) << e.first;
+    }
+}
+
+// Numbers are written in place: the bytes after the terminator are left alone
+TEST(PARSER, NumbersOnlyWriteTheirDigits) {
+    for (const uint64_t nonce : {(uint64_t) 0, (uint64_t) 12, (uint64_t) UINT64_MAX}) {
+        RlpItem tx = sampleTx();
+        tx.items[MANTX_FIELD_NONCE] = RlpItem::num(nonce);
+
+        ParsedTx p(tx.encode());
+        ASSERT_THAT(p.parse(), testing::Eq(parser_ok));
+        const int16_t idx = p.find("Nonce");
+        ASSERT_THAT(idx, testing::Ge(0));
+
+        const std::string expected = std::to_string(nonce);
+        char k[64];
+        char v[64];
+        uint8_t pageCount;
+        memset(v, 0xAA, sizeof(v));
+        ASSERT_THAT(parser_getItem(&p.ctx, idx, k, sizeof(k), v, sizeof(v), 0, &pageCount), testing::Eq(parser_ok));
+        ASSERT_THAT(std::string(v), testing::Eq(expected));
+        for (size_t i = expected.size() + 1; i < sizeof(v); i++) {
+            ASSERT_THAT((uint8_t) v[i], testing::Eq(0xAA)) << i;
+        }
+
+        // the digits and the terminator fit exactly
+        ASSERT_THAT(parser_getItem(&p.ctx, idx, k, sizeof(k), v, expected.size() + 1, 0, &pageCount),
+                    testing::Eq(parser_ok));
+        ASSERT_THAT(std::string(v), testing::Eq(expected));
+        ASSERT_THAT(parser_getItem(&p.ctx, idx, k, sizeof(k), v, expected.size(), 0, &pageCount),
+                    testing::Eq(parser_unexpected_field));
+    }
+}
+
+// extraTo entries are located on demand from checkpoints, so any access order gives what a linear walk gives
+TEST(PARSER, ExtraToRandomAccess) {
+    const uint16_t count = 64;
+    std::vector<RlpItem> extraTo;
+    std::vector<std::string> expected;
+    for (uint16_t i = 0; i < count; i++) {
+        const std::string to = "MAN.recipient" + std::to_string(i);
+        const uint64_t amount = (uint64_t) i * 1000003;
+        std::vector<uint8_t> payload((i * 7) % 50);
+        std::string payloadHex;
+        for (size_t j = 0; j < payload.size(); j++) {
+            payload[j] = (uint8_t) (i + j * 13);
+            char h[3];
+            snprintf(h, sizeof(h), "%02X", payload[j]);
+            payloadHex += h;
+        }
+        extraTo.push_back(RlpItem::list({RlpItem::str(to), RlpItem::num(amount), RlpItem::str(payload)}));
+        expected.insert(expected.end(), {to, std::to_string(amount), payloadHex});
+    }
+    RlpItem tx = sampleTx();
+    tx.items[MANTX_FIELD_EXTRA].items[0].items[2] = RlpItem::list(extraTo);
+
+    ParsedTx p(tx.encode());
+    ASSERT_THAT(p.parse(), testing::Eq(parser_ok));
+    ASSERT_THAT(parser_validate(&p.ctx), testing::Eq(parser_ok));
+    const int16_t first = p.find("[0] To");
+    ASSERT_THAT(first, testing::Ge(0));
+    const int16_t numItems = parser_getNumItems(&p.ctx);
+    ASSERT_THAT(numItems, testing::Eq(first + 3 * count));
+
+    // the linear walk, page by page as the device renders them
+    struct Page {
+        int16_t idx;
+        uint8_t page;
+        std::string key;
+        std::string value;
+    };
+    std::vector<Page> pages;
+    for (int16_t i = 0; i < numItems; i++) {
+        std::string whole;
+        uint8_t pageCount = 1;
+        for (uint8_t page = 0; page < std::max<uint8_t>(pageCount, 1); page++) {
+            char k[64];
+            char v[MAX_CHARS_PER_VALUE1_LINE];
+            ASSERT_THAT(parser_getItem(&p.ctx, i, k, sizeof(k), v, sizeof(v), page, &pageCount), testing::Eq(parser_ok));
+            pages.push_back({i, page, k, v});
+            whole += v;
+        }
+        if (i >= first) {
+            ASSERT_THAT(whole, testing::Eq(expected[i - first])) << "item " << i;
+        }
+    }
+
+    std::vector<Page> backwards(pages.rbegin(), pages.rend());
+    std::vector<Page> shuffled = pages;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(3));
+    for (const auto *order : {&backwards, &shuffled}) {
+        for (const auto &e : *order) {
+            char k[64];
+            char v[MAX_CHARS_PER_VALUE1_LINE];
+            uint8_t pageCount;
+            ASSERT_THAT(parser_getItem(&p.ctx, e.idx, k, sizeof(k), v, sizeof(v), e.page, &pageCount),
+                        testing::Eq(parser_ok));
+            ASSERT_THAT(std::string(k), testing::Eq(e.key)) << "item " << e.idx << " page " << (int) e.page;
+            ASSERT_THAT(std::string(v), testing::Eq(e.value)) << "item " << e.idx << " page " << (int) e.page;
+        }
+    }
+}
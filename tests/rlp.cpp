@@ -0,0 +1,380 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lib/rlp.h"
+#include "tx_builder.h"
+
+namespace {
+
+// Random trees with every form of item: single bytes, short and long strings, empty and nested lists
+RlpItem randomItem(std::mt19937 *rng, uint8_t depth, uint16_t *budget) {
+    (*budget)--;
+    const uint32_t pick = (*rng)() % 8;
+    if (depth > 0 && *budget > 0 && pick < 3) {
+        std::vector<RlpItem> items;
+        const uint32_t count = (*rng)() % 6;
+        for (uint32_t i = 0; i < count && *budget > 0; i++) {
+            items.push_back(randomItem(rng, depth - 1, budget));
+        }
+        return RlpItem::list(items);
+    }
+    const uint32_t len = pick == 3 ? 1 : pick == 4 ? 56 + (*rng)() % 200 : (*rng)() % 56;
+    std::vector<uint8_t> bytes(len);
+    for (auto &b : bytes) {
+        b = (uint8_t) (*rng)();
+    }
+    return RlpItem::str(bytes);
+}
+
+std::vector<RlpItem> sampleTrees() {
+    std::vector<RlpItem> trees = {sampleTx(), RlpItem::list({}), RlpItem::list({RlpItem::list({})})};
+    std::mt19937 rng(7);
+    for (int i = 0; i < 50; i++) {
+        uint16_t budget = 200;
+        trees.push_back(RlpItem::list({randomItem(&rng, 4, &budget), randomItem(&rng, 4, &budget)}));
+    }
+    return trees;
+}
+
+void expectSameNodes(const rlp_field_t *a, const rlp_field_t *b, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        EXPECT_THAT(a[i].kind, testing::Eq(b[i].kind)) << "node " << (int) i;
+        EXPECT_THAT(a[i].parent, testing::Eq(b[i].parent)) << "node " << (int) i;
+        EXPECT_THAT(a[i].firstChild, testing::Eq(b[i].firstChild)) << "node " << (int) i;
+        EXPECT_THAT(a[i].childCount, testing::Eq(b[i].childCount)) << "node " << (int) i;
+        EXPECT_THAT(a[i].fieldOffset, testing::Eq(b[i].fieldOffset)) << "node " << (int) i;
+        EXPECT_THAT(a[i].valueOffset, testing::Eq(b[i].valueOffset)) << "node " << (int) i;
+        EXPECT_THAT(a[i].valueLen, testing::Eq(b[i].valueLen)) << "node " << (int) i;
+    }
+}
+
+// Walks the list with an iterator and checks every item, at every depth, against the index
+void expectIterMatchesIndex(const uint8_t *data, const rlp_field_t *nodes, uint8_t listIdx) {
+    const rlp_field_t *list = nodes + listIdx;
+    rlp_iter_t iter;
+    ASSERT_THAT(rlp_iterInit(&iter, data, list), testing::Eq(RLP_NO_ERROR));
+
+    for (uint8_t i = 0; i < list->childCount; i++) {
+        const uint8_t childIdx = list->firstChild + i;
+        const rlp_field_t *expected = nodes + childIdx;
+        ASSERT_FALSE(rlp_iterDone(&iter)) << "node " << (int) childIdx;
+
+        rlp_field_t item;
+        ASSERT_THAT(rlp_iterNext(&iter, &item), testing::Eq(RLP_NO_ERROR));
+        ASSERT_THAT(item.kind, testing::Eq(expected->kind)) << "node " << (int) childIdx;
+        ASSERT_THAT(item.fieldOffset, testing::Eq(expected->fieldOffset)) << "node " << (int) childIdx;
+        ASSERT_THAT(item.valueOffset, testing::Eq(expected->valueOffset)) << "node " << (int) childIdx;
+        ASSERT_THAT(item.valueLen, testing::Eq(expected->valueLen)) << "node " << (int) childIdx;
+        ASSERT_THAT(iter.offset, testing::Eq(rlp_fieldEnd(expected)));
+
+        if (expected->kind == RLP_KIND_LIST) {
+            expectIterMatchesIndex(data, nodes, childIdx);
+        }
+    }
+
+    ASSERT_TRUE(rlp_iterDone(&iter));
+    rlp_field_t item;
+    ASSERT_THAT(rlp_iterNext(&iter, &item), testing::Eq(RLP_ERROR_NO_MORE_ITEMS));
+}
+
+}
+
+TEST(RLP, IndexRejectsTrailingBytes) {
+    std::vector<uint8_t> buffer = sampleTx().encode();
+    rlp_field_t nodes[255];
+    uint8_t nodeCount;
+    ASSERT_THAT(rlp_indexStream(buffer.data(), buffer.size(), nodes, 255, &nodeCount), testing::Eq(RLP_NO_ERROR));
+
+    buffer.push_back(0x00);
+    ASSERT_THAT(rlp_indexStream(buffer.data(), buffer.size(), nodes, 255, &nodeCount),
+                testing::Eq(RLP_ERROR_INVALID_VALUE_LEN));
+
+    // a single byte root is one byte long
+    const uint8_t twoBytes[] = {0x05, 0x05};
+    ASSERT_THAT(rlp_indexStream(twoBytes, 1, nodes, 255, &nodeCount), testing::Eq(RLP_NO_ERROR));
+    ASSERT_THAT(rlp_indexStream(twoBytes, 2, nodes, 255, &nodeCount), testing::Eq(RLP_ERROR_INVALID_VALUE_LEN));
+}
+
+// Feeding the stream as it arrives, in chunks of any size, indexes the same tree as a single call
+TEST(RLP, IndexerChunksMatchOneShot) {
+    std::mt19937 rng(11);
+    for (const auto &tree : sampleTrees()) {
+        const std::vector<uint8_t> buffer = tree.encode();
+        ASSERT_THAT(buffer.size(), testing::Le(UINT16_MAX));
+
+        rlp_field_t expected[255];
+        uint8_t expectedCount;
+        ASSERT_THAT(rlp_indexStream(buffer.data(), buffer.size(), expected, 255, &expectedCount),
+                    testing::Eq(RLP_NO_ERROR));
+
+        for (int split = 0; split < 8; split++) {
+            rlp_field_t nodes[255];
+            rlp_indexer_t indexer;
+            rlp_indexerInit(&indexer, nodes, 255, RLP_NO_MAX_DEPTH);
+
+            size_t received = 0;
+            while (received < buffer.size()) {
+                // one byte at a time on the first pass, random chunks afterwards
+                const size_t chunk = split == 0 ? 1 : 1 + rng() % 64;
+                received = std::min(buffer.size(), received + chunk);
+                // only offsets are kept, so the received bytes may be in a new buffer on every call
+                const std::vector<uint8_t> copy(buffer.begin(), buffer.begin() + received);
+                ASSERT_THAT(rlp_indexerFeed(&indexer, copy.data(), copy.size()), testing::Eq(RLP_NO_ERROR));
+                if (received < buffer.size()) {
+                    ASSERT_THAT(rlp_indexerFinish(&indexer, received), testing::Eq(RLP_ERROR_TRUNCATED));
+                }
+            }
+
+            ASSERT_THAT(rlp_indexerFinish(&indexer, buffer.size()), testing::Eq(RLP_NO_ERROR));
+            ASSERT_THAT(indexer.nodeCount, testing::Eq(expectedCount));
+            expectSameNodes(nodes, expected, expectedCount);
+        }
+    }
+}
+
+TEST(RLP, IterMatchesIndex) {
+    for (const auto &tree : sampleTrees()) {
+        const std::vector<uint8_t> buffer = tree.encode();
+        rlp_field_t nodes[255];
+        uint8_t nodeCount;
+        ASSERT_THAT(rlp_indexStream(buffer.data(), buffer.size(), nodes, 255, &nodeCount), testing::Eq(RLP_NO_ERROR));
+        expectIterMatchesIndex(buffer.data(), nodes, 0);
+    }
+}
+
+TEST(RLP, IterEmptyLists) {
+    // [[], [[]], "", []]
+    const RlpItem tree = RlpItem::list({RlpItem::list({}), RlpItem::list({RlpItem::list({})}),
+                                        RlpItem::str(std::vector<uint8_t>{}), RlpItem::list({})});
+    const std::vector<uint8_t> buffer = tree.encode();
+    rlp_field_t nodes[255];
+    uint8_t nodeCount;
+    ASSERT_THAT(rlp_indexStream(buffer.data(), buffer.size(), nodes, 255, &nodeCount), testing::Eq(RLP_NO_ERROR));
+    ASSERT_THAT(nodeCount, testing::Eq(6));
+    expectIterMatchesIndex(buffer.data(), nodes, 0);
+
+    rlp_iter_t iter;
+    rlp_iter_t child;
+    ASSERT_THAT(rlp_iterInit(&iter, buffer.data(), nodes), testing::Eq(RLP_NO_ERROR));
+    ASSERT_THAT(rlp_iterNextList(&iter, &child), testing::Eq(RLP_NO_ERROR));
+    ASSERT_TRUE(rlp_iterDone(&child));
+
+    // strings are not lists, and the iterator does not move on errors
+    rlp_field_t item;
+    ASSERT_THAT(rlp_iterNextList(&iter, &child), testing::Eq(RLP_NO_ERROR));
+    const uint16_t offset = iter.offset;
+    ASSERT_THAT(rlp_iterNextList(&iter, &child), testing::Eq(RLP_ERROR_INVALID_KIND));
+    ASSERT_THAT(iter.offset, testing::Eq(offset));
+    const uint8_t *bytes;
+    uint16_t bytesLen;
+    ASSERT_THAT(rlp_iterNextBytes(&iter, &bytes, &bytesLen), testing::Eq(RLP_NO_ERROR));
+    ASSERT_THAT(bytesLen, testing::Eq(0));
+    ASSERT_THAT(rlp_iterNextBytes(&iter, &bytes, &bytesLen), testing::Eq(RLP_ERROR_INVALID_KIND));
+    ASSERT_THAT(rlp_iterNext(&iter, &item), testing::Eq(RLP_NO_ERROR));
+    ASSERT_TRUE(rlp_iterDone(&iter));
+
+    // only lists can be iterated
+    ASSERT_THAT(rlp_iterInit(&iter, buffer.data(), &item), testing::Eq(RLP_NO_ERROR));
+    item.kind = RLP_KIND_STRING;
+    ASSERT_THAT(rlp_iterInit(&iter, buffer.data(), &item), testing::Eq(RLP_ERROR_INVALID_KIND));
+}
+
+// An item that runs past the end of its list is rejected by the iterator with the error of the indexer
+TEST(RLP, IterTruncatedLists) {
+    const std::vector<std::vector<uint8_t>> buffers = {
+            {0xC2, 0x82, 0xAA},                         // string of 2 bytes in a list of 2 bytes
+            {0xC3, 0x01, 0x82, 0xAA},                   // the same after a valid item
+            {0xC3, 0xC3, 0x01, 0x02, 0x03},             // list of 3 bytes in a list of 3 bytes
+            {0xC4, 0x01, 0x02, 0xB8, 0x05},             // long string header in a list of 4 bytes
+            {0xC5, 0xC3, 0xC2, 0x82, 0xAA, 0xBB},       // too long two levels down
+            {0xC2, 0xB9, 0x01},                         // long string length cut by the list end
+    };
+    for (const auto &buffer : buffers) {
+        rlp_field_t nodes[255];
+        uint8_t nodeCount;
+        const int8_t indexErr = rlp_indexStream(buffer.data(), buffer.size(), nodes, 255, &nodeCount);
+        ASSERT_THAT(indexErr, testing::Ne(RLP_NO_ERROR));
+
+        // walk everything the iterator accepts, depth first, until it stops on the bad item
+        rlp_field_t root;
+        ASSERT_THAT(rlp_decode(buffer.data(), buffer.data() + buffer.size(), &root.kind, &root.valueLen,
+                               &root.valueOffset), testing::Gt(0));
+        root.fieldOffset = 0;
+        std::vector<rlp_iter_t> stack(1);
+        ASSERT_THAT(rlp_iterInit(&stack[0], buffer.data(), &root), testing::Eq(RLP_NO_ERROR));
+        int8_t iterErr = RLP_NO_ERROR;
+        while (!stack.empty() && iterErr == RLP_NO_ERROR) {
+            rlp_iter_t &iter = stack.back();
+            if (rlp_iterDone(&iter)) {
+                stack.pop_back();
+                continue;
+            }
+            const uint16_t offset = iter.offset;
+            rlp_field_t item;
+            iterErr = rlp_iterNext(&iter, &item);
+            if (iterErr != RLP_NO_ERROR) {
+                ASSERT_THAT(iter.offset, testing::Eq(offset));
+                ASSERT_THAT(rlp_iterNext(&iter, &item), testing::Eq(iterErr));
+            } else if (item.kind == RLP_KIND_LIST) {
+                rlp_iter_t child;
+                ASSERT_THAT(rlp_iterInit(&child, buffer.data(), &item), testing::Eq(RLP_NO_ERROR));
+                stack.push_back(child);
+            }
+        }
+        ASSERT_THAT(iterErr, testing::Eq(indexErr));
+    }
+}
+
+namespace {
+
+// The pages a field is expected to have, cut from its whole rendered value
+std::vector<std::string> expectedPages(const std::string &rendered, uint16_t maxLen, bool hex) {
+    size_t pageLen = maxLen - 1;
+    if (hex) {
+        pageLen &= ~(size_t) 1;
+    }
+    std::vector<std::string> pages;
+    for (size_t offset = 0; offset < rendered.size(); offset += pageLen) {
+        pages.push_back(rendered.substr(offset, pageLen));
+    }
+    return pages;
+}
+
+std::string hexOf(const std::vector<uint8_t> &bytes) {
+    std::string out;
+    char pair[3];
+    for (const uint8_t b : bytes) {
+        snprintf(pair, sizeof(pair), "%02X", b);
+        out += pair;
+    }
+    return out;
+}
+
+// Renders every page with the geometry computed once, and each page again with the per-page functions
+void expectPages(const std::vector<uint8_t> &value, uint16_t maxLen, bool hex) {
+    const std::vector<uint8_t> buffer = RlpItem::str(value).encode();
+    rlp_field_t field;
+    ASSERT_THAT(rlp_decode(buffer.data(), buffer.data() + buffer.size(), &field.kind, &field.valueLen,
+                           &field.valueOffset), testing::Eq((int16_t) buffer.size()));
+    field.fieldOffset = 0;
+
+    const std::string rendered = hex ? hexOf(value) : std::string(value.begin(), value.end());
+    const std::vector<std::string> expected = expectedPages(rendered, maxLen, hex);
+    const std::string where = "length " + std::to_string(value.size()) + " maxLen " + std::to_string(maxLen);
+
+    rlp_paging_t paging;
+    ASSERT_THAT(rlp_pagingInit(&paging, &field, maxLen, hex), testing::Eq(RLP_NO_ERROR)) << where;
+    ASSERT_THAT(paging.pageCount, testing::Eq(expected.size())) << where;
+    ASSERT_THAT(paging.totalLen, testing::Eq(rendered.size())) << where;
+
+    for (uint8_t page = 0; page < paging.pageCount; page++) {
+        // nothing is written past the page and its terminator
+        std::vector<char> out(maxLen + 4, 'x');
+        uint16_t outLen;
+        ASSERT_THAT(rlp_readPage(buffer.data(), &field, &paging, out.data(), &outLen, page),
+                    testing::Eq(RLP_NO_ERROR)) << where;
+        ASSERT_THAT(std::string(out.data()), testing::Eq(expected[page])) << where << " page " << (int) page;
+        ASSERT_THAT(outLen, testing::Eq(expected[page].size())) << where;
+        ASSERT_THAT(std::string(out.begin() + outLen + 1, out.end()), testing::Eq(std::string(maxLen + 3 - outLen, 'x')));
+
+        std::vector<char> perPage(maxLen);
+        uint16_t perPageLen;
+        uint8_t pageCount;
+        const int8_t err = hex
+                           ? rlp_readHexPaging(buffer.data(), &field, perPage.data(), maxLen, &perPageLen, page, &pageCount)
+                           : rlp_readStringPaging(buffer.data(), &field, perPage.data(), maxLen, &perPageLen, page, &pageCount);
+        ASSERT_THAT(err, testing::Eq(RLP_NO_ERROR)) << where;
+        ASSERT_THAT(pageCount, testing::Eq(paging.pageCount)) << where;
+        ASSERT_THAT(std::string(perPage.data()), testing::Eq(expected[page])) << where;
+    }
+
+    // the page right after the last one is empty when the value fills its pages, later pages do not exist
+    std::vector<char> out(maxLen);
+    uint16_t outLen;
+    const uint32_t lastOffset = (uint32_t) paging.pageCount * paging.pageLen;
+    if (paging.pageCount < UINT8_MAX) {
+        ASSERT_THAT(rlp_readPage(buffer.data(), &field, &paging, out.data(), &outLen, paging.pageCount),
+                    testing::Eq(lastOffset == paging.totalLen ? RLP_NO_ERROR : RLP_ERROR_INVALID_PAGE)) << where;
+    }
+    if (paging.pageCount < UINT8_MAX - 1) {
+        ASSERT_THAT(rlp_readPage(buffer.data(), &field, &paging, out.data(), &outLen, paging.pageCount + 1),
+                    testing::Eq(RLP_ERROR_INVALID_PAGE)) << where;
+    }
+}
+
+}
+
+// Lengths just below, at and above whole pages, for string and hex pages of odd and even sizes
+TEST(RLP, PagingBoundaries) {
+    std::mt19937 rng(23);
+    for (const uint16_t maxLen : {3, 4, 5, 17, 18, 37, 64}) {
+        for (const bool hex : {false, true}) {
+            const uint16_t pageLen = hex ? (maxLen - 1) & ~1u : maxLen - 1;
+            const uint16_t bytesPerPage = hex ? pageLen / 2 : pageLen;
+            for (uint16_t pages = 0; pages <= 4; pages++) {
+                for (const int delta : {-1, 0, 1}) {
+                    const int len = pages * bytesPerPage + delta;
+                    if (len < 0) {
+                        continue;
+                    }
+                    std::vector<uint8_t> value(len);
+                    for (auto &b : value) {
+                        b = hex ? (uint8_t) rng() : (uint8_t) ('a' + rng() % 26);
+                    }
+                    expectPages(value, maxLen, hex);
+                }
+            }
+        }
+    }
+}
+
+TEST(RLP, PagingLimits) {
+    const std::vector<uint8_t> buffer = RlpItem::str(std::vector<uint8_t>(100, 0xAB)).encode();
+    rlp_field_t field;
+    rlp_decode(buffer.data(), buffer.data() + buffer.size(), &field.kind, &field.valueLen, &field.valueOffset);
+    field.fieldOffset = 0;
+
+    rlp_paging_t paging;
+    ASSERT_THAT(rlp_pagingInit(&paging, &field, 2, 0), testing::Eq(RLP_ERROR_BUFFER_TOO_SMALL));
+    ASSERT_THAT(rlp_pagingInit(&paging, &field, 3, 1), testing::Eq(RLP_NO_ERROR));
+    ASSERT_THAT(paging.pageLen, testing::Eq(2));
+    ASSERT_THAT(paging.pageCount, testing::Eq(100));
+
+    // 255 pages at most
+    const std::vector<uint8_t> big = RlpItem::str(std::vector<uint8_t>(255 * 2 + 1, 'a')).encode();
+    rlp_decode(big.data(), big.data() + big.size(), &field.kind, &field.valueLen, &field.valueOffset);
+    ASSERT_THAT(rlp_pagingInit(&paging, &field, 3, 0), testing::Eq(RLP_ERROR_INVALID_PAGE));
+    ASSERT_THAT(rlp_pagingInit(&paging, &field, 4, 0), testing::Eq(RLP_NO_ERROR));
+    ASSERT_THAT(paging.pageCount, testing::Eq(171));
+
+    // single bytes are values of one byte, lists have no pages
+    const uint8_t byte[] = {0x41};
+    rlp_decode(byte, byte + 1, &field.kind, &field.valueLen, &field.valueOffset);
+    ASSERT_THAT(rlp_pagingInit(&paging, &field, 3, 1), testing::Eq(RLP_NO_ERROR));
+    char out[3];
+    uint16_t outLen;
+    ASSERT_THAT(rlp_readPage(byte, &field, &paging, out, &outLen, 0), testing::Eq(RLP_NO_ERROR));
+    ASSERT_THAT(std::string(out), testing::Eq("41"));
+    field.kind = RLP_KIND_LIST;
+    ASSERT_THAT(rlp_pagingInit(&paging, &field, 3, 0), testing::Eq(RLP_ERROR_INVALID_KIND));
+}
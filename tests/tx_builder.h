@@ -0,0 +1,113 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// Raw RLP trees for tests that need fields the encoder cannot produce (oversized numbers, ...)
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lib/parser_txdef.h"
+
+struct RlpItem {
+    bool isList = false;
+    std::vector<uint8_t> bytes;
+    std::vector<RlpItem> items;
+
+    static RlpItem str(const std::vector<uint8_t> &b) {
+        RlpItem r;
+        r.bytes = b;
+        return r;
+    }
+
+    static RlpItem str(const std::string &s) {
+        return str(std::vector<uint8_t>(s.begin(), s.end()));
+    }
+
+    // minimal big endian bytes, as numbers are encoded
+    static RlpItem num(uint64_t v) {
+        std::vector<uint8_t> b;
+        for (; v != 0; v >>= 8) {
+            b.insert(b.begin(), (uint8_t) v);
+        }
+        return str(b);
+    }
+
+    static RlpItem list(const std::vector<RlpItem> &items) {
+        RlpItem r;
+        r.isList = true;
+        r.items = items;
+        return r;
+    }
+
+    std::vector<uint8_t> encode() const {
+        std::vector<uint8_t> payload;
+        if (!isList) {
+            if (bytes.size() == 1 && bytes[0] < 0x80) {
+                return bytes;
+            }
+            payload = bytes;
+        } else {
+            for (const auto &item : items) {
+                const auto e = item.encode();
+                payload.insert(payload.end(), e.begin(), e.end());
+            }
+        }
+
+        const uint8_t offset = isList ? 0xC0 : 0x80;
+        std::vector<uint8_t> out;
+        if (payload.size() < 56) {
+            out.push_back((uint8_t) (offset + payload.size()));
+        } else {
+            std::vector<uint8_t> len;
+            for (size_t v = payload.size(); v != 0; v >>= 8) {
+                len.insert(len.begin(), (uint8_t) v);
+            }
+            out.push_back((uint8_t) (offset + 55 + len.size()));
+            out.insert(out.end(), len.begin(), len.end());
+        }
+        out.insert(out.end(), payload.begin(), payload.end());
+        return out;
+    }
+};
+
+// A valid Normal tx with one extraTo recipient. Tests replace the fields they are about
+inline RlpItem sampleTx() {
+    const RlpItem extraTo = RlpItem::list({
+            RlpItem::str("MAN.2skMrkoEkie1UhQ8gf2tMbP3Q7gJ"),
+            RlpItem::num(3),
+            RlpItem::str(std::vector<uint8_t>{0xDE, 0xAD}),
+    });
+    return RlpItem::list({
+            RlpItem::num(12),                                   // nonce
+            RlpItem::num(18000000000),                          // gasPrice
+            RlpItem::num(21000),                                // gasLimit
+            RlpItem::str("MAN.3uK6bsVd5q2uw6zTZfFhZWVf3Z4oM"),   // to
+            RlpItem::num(1000000000000000005),                  // value
+            RlpItem::str(std::vector<uint8_t>{0x01, 0x02, 0xAB}), // data
+            RlpItem::num(3),                                    // v
+            RlpItem::num(0),                                    // r
+            RlpItem::num(0),                                    // s
+            RlpItem::num(0),                                    // enterType
+            RlpItem::num(0),                                    // isEntrustTx
+            RlpItem::num(1546300800),                           // commitTime
+            RlpItem::list({RlpItem::list({
+                    RlpItem::num(MANTX_TXTYPE_NORMAL),
+                    RlpItem::num(7),
+                    RlpItem::list({extraTo}),
+            })}),
+    });
+}
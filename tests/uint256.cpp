@@ -0,0 +1,230 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <string>
+
+#include "utils/uint256.h"
+#include "utils/uint256.hpp"
+#include "uint256_portable.h"
+
+namespace {
+
+// words are given from the most significant one
+uint256_t make256(uint64_t w3, uint64_t w2, uint64_t w1, uint64_t w0) {
+    uint256_t v;
+    UPPER(UPPER(v)) = w3;
+    LOWER(UPPER(v)) = w2;
+    UPPER(LOWER(v)) = w1;
+    LOWER(LOWER(v)) = w0;
+    return v;
+}
+
+// xorshift64, with a share of all-zero and all-one words so that carries cross every word boundary
+uint64_t nextWord(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    switch (*state % 4) {
+        case 0:
+            return 0;
+        case 1:
+            return UINT64_MAX;
+        default:
+            return *state * 0x2545F4914F6CDD1DULL;
+    }
+}
+
+uint256_t random256(uint64_t *state) {
+    const uint64_t w3 = nextWord(state);
+    const uint64_t w2 = nextWord(state);
+    const uint64_t w1 = nextWord(state);
+    const uint64_t w0 = nextWord(state);
+    return make256(w3, w2, w1, w0);
+}
+
+std::string hex(uint256_t v) {
+    char out[65];
+    if (!tostring256(&v, 16, out, sizeof(out))) {
+        return "?";
+    }
+    return out;
+}
+
+}
+
+// The portable mul256 used to lose carries from the third 64-bit word into the fourth
+TEST(UINT256, Mul256CarryIntoTopWord) {
+    const uint64_t M = UINT64_MAX;
+    const struct {
+        uint256_t a;
+        uint256_t b;
+        const char *product;
+    } vectors[] = {
+            // (2^128 - 1)^2
+            {make256(0, 0, M, M), make256(0, 0, M, M),
+                    "fffffffffffffffffffffffffffffffe00000000000000000000000000000001"},
+            {make256(0, 1, 0, M), make256(0, 0, 1, M),
+                    "20000000000000000fffffffffffffffd0000000000000001"},
+            // (2^256 - 1) * b is -b
+            {make256(M, M, M, M), make256(0, 0x0ec6680cabb95f09ULL, 0x6465f271027abfa8ULL, 0x0000000000986a68ULL),
+                    "fffffffffffffffff13997f35446a0f69b9a0d8efd854057ffffffffff679598"},
+    };
+
+    for (const auto &v : vectors) {
+        uint256_t a = v.a;
+        uint256_t b = v.b;
+        uint256_t native;
+        uint256_t portable;
+        mul256(&a, &b, &native);
+        portable_mul256(&a, &b, &portable);
+        ASSERT_THAT(hex(native), testing::Eq(v.product));
+        ASSERT_THAT(hex(portable), testing::Eq(v.product));
+    }
+}
+
+TEST(UINT256, NativeMatchesPortable) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < 20000; i++) {
+        uint256_t a = random256(&state);
+        uint256_t b = random256(&state);
+        uint256_t native;
+        uint256_t portable;
+
+        add256(&a, &b, &native);
+        portable_add256(&a, &b, &portable);
+        ASSERT_TRUE(equal256(&native, &portable)) << "add " << hex(a) << " " << hex(b);
+
+        minus256(&a, &b, &native);
+        portable_minus256(&a, &b, &portable);
+        ASSERT_TRUE(equal256(&native, &portable)) << "minus " << hex(a) << " " << hex(b);
+
+        mul256(&a, &b, &native);
+        portable_mul256(&a, &b, &portable);
+        ASSERT_TRUE(equal256(&native, &portable)) << "mul " << hex(a) << " " << hex(b);
+
+        // the target may alias an operand
+        native = a;
+        portable = a;
+        mul256(&native, &b, &native);
+        portable_mul256(&portable, &b, &portable);
+        ASSERT_TRUE(equal256(&native, &portable)) << "mul aliased " << hex(a) << " " << hex(b);
+
+        if (!zero256(&b)) {
+            uint256_t nativeMod;
+            uint256_t portableMod;
+            divmod256(&a, &b, &native, &nativeMod);
+            portable_divmod256(&a, &b, &portable, &portableMod);
+            ASSERT_TRUE(equal256(&native, &portable)) << "div " << hex(a) << " " << hex(b);
+            ASSERT_TRUE(equal256(&nativeMod, &portableMod)) << "mod " << hex(a) << " " << hex(b);
+        }
+
+        char nativeDec[80];
+        char portableDec[80];
+        ASSERT_TRUE(tostring256(&a, 10, nativeDec, sizeof(nativeDec)));
+        ASSERT_TRUE(portable_tostring256(&a, 10, portableDec, sizeof(portableDec)));
+        ASSERT_THAT(std::string(nativeDec), testing::Eq(portableDec));
+    }
+}
+
+// Powers of ten and their neighbours cross every decimal limb boundary, 10^9 for the device and 10^19 for hosts
+TEST(UINT256, DecimalAtPowersOfTen) {
+    uint256_t ten = make256(0, 0, 0, 10);
+    uint256_t one = make256(0, 0, 0, 1);
+    uint256_t power = one;
+    for (int k = 0; k < 78; k++) {
+        uint256_t below;
+        uint256_t above;
+        minus256(&power, &one, &below);
+        add256(&power, &one, &above);
+
+        const std::string zeros(k, '0');
+        const std::string expected[] = {k == 0 ? "0" : std::string(k, '9'), "1" + zeros,
+                                        k == 0 ? "2" : "1" + std::string(k - 1, '0') + "1"};
+        uint256_t values[] = {below, power, above};
+        for (int i = 0; i < 3; i++) {
+            char nativeDec[80];
+            char portableDec[80];
+            ASSERT_TRUE(tostring256(&values[i], 10, nativeDec, sizeof(nativeDec)));
+            ASSERT_TRUE(portable_tostring256(&values[i], 10, portableDec, sizeof(portableDec)));
+            ASSERT_THAT(std::string(nativeDec), testing::Eq(expected[i])) << "10^" << k;
+            ASSERT_THAT(std::string(portableDec), testing::Eq(expected[i])) << "10^" << k;
+        }
+
+        mul256(&power, &ten, &power);
+    }
+}
+
+// The constexpr wrapper gives the same results as uint256.c
+TEST(UINT256, WrapperMatchesC) {
+    uint64_t state = 0xD1B54A32D192ED03ULL;
+    for (int i = 0; i < 20000; i++) {
+        uint256_t a = random256(&state);
+        uint256_t b = random256(&state);
+        const uint32_t shift = (uint32_t) (nextWord(&state) % 256);
+        const mantx::uint256 wa(a);
+        const mantx::uint256 wb(b);
+        uint256_t expected;
+        uint256_t actual;
+
+        add256(&a, &b, &expected);
+        actual = (wa + wb).to_c();
+        ASSERT_TRUE(equal256(&expected, &actual)) << "add " << hex(a) << " " << hex(b);
+
+        minus256(&a, &b, &expected);
+        actual = (wa - wb).to_c();
+        ASSERT_TRUE(equal256(&expected, &actual)) << "minus " << hex(a) << " " << hex(b);
+
+        mul256(&a, &b, &expected);
+        actual = (wa * wb).to_c();
+        ASSERT_TRUE(equal256(&expected, &actual)) << "mul " << hex(a) << " " << hex(b);
+
+        if (!zero256(&b)) {
+            uint256_t mod;
+            divmod256(&a, &b, &expected, &mod);
+            actual = (wa / wb).to_c();
+            ASSERT_TRUE(equal256(&expected, &actual)) << "div " << hex(a) << " " << hex(b);
+            actual = (wa % wb).to_c();
+            ASSERT_TRUE(equal256(&mod, &actual)) << "mod " << hex(a) << " " << hex(b);
+        }
+
+        shiftl256(&a, shift, &expected);
+        actual = (wa << shift).to_c();
+        ASSERT_TRUE(equal256(&expected, &actual)) << "shiftl " << hex(a) << " " << shift;
+
+        shiftr256(&a, shift, &expected);
+        actual = (wa >> shift).to_c();
+        ASSERT_TRUE(equal256(&expected, &actual)) << "shiftr " << hex(a) << " " << shift;
+
+        ASSERT_THAT(gt256(&a, &b), testing::Eq(wa > wb));
+
+        char dec[80];
+        ASSERT_TRUE(tostring256(&a, 10, dec, sizeof(dec)));
+        ASSERT_THAT(std::string(wa.to_decimal().data()), testing::Eq(dec));
+
+        // base 16 goes through a division per digit, so it is checked less often
+        if (i % 16 == 0) {
+            ASSERT_THAT(std::string(wa.to_hex().data()), testing::Eq(hex(a)));
+        }
+
+        uint8_t bytes[32];
+        writeu256BE(&a, bytes);
+        mantx::uint256 read;
+        ASSERT_TRUE(mantx::uint256::from_be_bytes(bytes, sizeof(bytes), read));
+        ASSERT_TRUE(read == wa);
+    }
+}
@@ -0,0 +1,56 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// uint256.c with the portable backend and every function renamed, see uint256_portable.h
+
+#define UINT256_PORTABLE
+
+#define readu128BE portable_readu128BE
+#define readu256BE portable_readu256BE
+#define writeu128BE portable_writeu128BE
+#define writeu256BE portable_writeu256BE
+#define zero128 portable_zero128
+#define zero256 portable_zero256
+#define copy128 portable_copy128
+#define copy256 portable_copy256
+#define clear128 portable_clear128
+#define clear256 portable_clear256
+#define shiftl128 portable_shiftl128
+#define shiftr128 portable_shiftr128
+#define shiftl256 portable_shiftl256
+#define shiftr256 portable_shiftr256
+#define bits128 portable_bits128
+#define bits256 portable_bits256
+#define equal128 portable_equal128
+#define equal256 portable_equal256
+#define gt128 portable_gt128
+#define gt256 portable_gt256
+#define gte128 portable_gte128
+#define gte256 portable_gte256
+#define add128 portable_add128
+#define add256 portable_add256
+#define minus128 portable_minus128
+#define minus256 portable_minus256
+#define or128 portable_or128
+#define or256 portable_or256
+#define mul128 portable_mul128
+#define mul256 portable_mul256
+#define divmod128 portable_divmod128
+#define divmod256 portable_divmod256
+#define tostring128 portable_tostring128
+#define tostring256 portable_tostring256
+
+#include "utils/uint256.c"
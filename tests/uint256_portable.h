@@ -0,0 +1,35 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// The portable backend of uint256.c, built next to the native one of the host build.
+// Every function has a portable_ prefix
+
+#include "utils/uint256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void portable_add256(uint256_t *number1, uint256_t *number2, uint256_t *target);
+void portable_minus256(uint256_t *number1, uint256_t *number2, uint256_t *target);
+void portable_mul256(uint256_t *number1, uint256_t *number2, uint256_t *target);
+void portable_divmod256(uint256_t *l, uint256_t *r, uint256_t *div, uint256_t *mod);
+bool portable_tostring256(uint256_t *number, uint32_t base, char *out, uint32_t outLength);
+
+#ifdef __cplusplus
+}
+#endif
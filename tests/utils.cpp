@@ -0,0 +1,186 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+#include "gmock/gmock.h"
+
+#include <cstdio>
+#include <ctime>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utils/utils.h"
+#include "utils_portable.h"
+
+namespace {
+
+const uint64_t secondsPerDay = 86400;
+// the calendar repeats every 400 years
+const uint64_t daysPer400Years = 146097;
+
+std::string printed(uint64_t t, uint8_t format) {
+    char out[64];
+    printTimeFormat(out, sizeof(out), t, format);
+    return out;
+}
+
+// the same text built from the C library
+std::string expected(uint64_t t, uint8_t format) {
+    const time_t tt = (time_t) t;
+    struct tm tm{};
+    EXPECT_THAT(gmtime_r(&tt, &tm), testing::NotNull()) << t;
+
+    static const char *monthNames[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                       "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    const long long year = (long long) tm.tm_year + 1900;
+    char out[64];
+    if (format == TIME_FORMAT_ISO8601) {
+        snprintf(out, sizeof(out), "%lld-%02d-%02dT%02d:%02d:%02dZ",
+                 year, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    } else {
+        snprintf(out, sizeof(out), "%02d%s%lld %02d:%02d:%02d",
+                 tm.tm_mday, monthNames[tm.tm_mon], year, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    }
+    return out;
+}
+
+void expectDayBoundary(uint64_t day) {
+    for (const uint8_t format : {TIME_FORMAT_DEFAULT, TIME_FORMAT_ISO8601}) {
+        const uint64_t t = day * secondsPerDay;
+        if (t > 0) {
+            ASSERT_THAT(printed(t - 1, format), testing::Eq(expected(t - 1, format)));
+        }
+        ASSERT_THAT(printed(t, format), testing::Eq(expected(t, format)));
+    }
+}
+
+}
+
+TEST(UTILS, PrintTimeFormats) {
+    char out[64];
+    printTime(out, sizeof(out), 1546300800);
+    ASSERT_THAT(std::string(out), testing::Eq("01Jan2019 00:00:00"));
+    ASSERT_THAT(printed(1546300800, TIME_FORMAT_DEFAULT), testing::Eq("01Jan2019 00:00:00"));
+    ASSERT_THAT(printed(1546300800, TIME_FORMAT_ISO8601), testing::Eq("2019-01-01T00:00:00Z"));
+    ASSERT_THAT(printed(951868799, TIME_FORMAT_ISO8601), testing::Eq("2000-02-29T23:59:59Z"));
+    ASSERT_THAT(printed(0, TIME_FORMAT_ISO8601), testing::Eq("1970-01-01T00:00:00Z"));
+}
+
+// Every day of a whole 400 year cycle, so every kind of leap year and month end is crossed
+TEST(UTILS, PrintTimeDayBoundaries) {
+    for (uint64_t day = 0; day <= daysPer400Years + 1; day++) {
+        expectDayBoundary(day);
+    }
+}
+
+// Sparse days up to the last one gmtime_r can represent
+TEST(UTILS, PrintTimeFarDayBoundaries) {
+    // tm_year is an int
+    const uint64_t lastDay = ((uint64_t) INT32_MAX - 1970) / 400 * daysPer400Years;
+    ASSERT_THAT(sizeof(time_t), testing::Ge(8u));
+    for (uint64_t day = daysPer400Years; day < lastDay; day += day / 7 + 1) {
+        expectDayBoundary(day);
+    }
+    expectDayBoundary(lastDay);
+}
+
+// Beyond gmtime_r, dates repeat every 400 years up to the largest uint64_t
+TEST(UTILS, PrintTimeWholeRange) {
+    const uint64_t cycle = daysPer400Years * secondsPerDay;
+    const uint64_t cycles = UINT64_MAX / cycle;
+    for (const uint64_t t : {(uint64_t) 0, (uint64_t) 951868799, (uint64_t) 1546300800, UINT64_MAX % cycle}) {
+        const std::string base = printed(t, TIME_FORMAT_ISO8601);
+        const long long baseYear = std::stoll(base);
+        for (const uint64_t k : {(uint64_t) 1, (uint64_t) 12345, cycles / 2, cycles - 1}) {
+            const std::string shifted = printed(t + k * cycle, TIME_FORMAT_ISO8601);
+            const uint64_t year = std::stoull(shifted);
+            ASSERT_THAT(year, testing::Eq((uint64_t) baseYear + 400 * k)) << shifted;
+            ASSERT_THAT(shifted.substr(shifted.find('-')), testing::Eq(base.substr(base.find('-'))));
+        }
+    }
+    ASSERT_THAT(printed(UINT64_MAX, TIME_FORMAT_ISO8601), testing::Eq("584554051223-11-09T07:00:15Z"));
+}
+
+namespace {
+
+typedef int8_t (*hexEncoder_t)(char *, uint16_t, const uint8_t *, uint16_t);
+
+std::string sprintfHex(const std::vector<uint8_t> &in) {
+    std::string out;
+    char pair[3];
+    for (const uint8_t b : in) {
+        snprintf(pair, sizeof(pair), "%02X", b);
+        out += pair;
+    }
+    return out;
+}
+
+// Lengths around the 16 byte blocks of the SIMD path, so that every tail length is covered
+void expectHexEncode(hexEncoder_t encode) {
+    std::mt19937 rng(21);
+    for (uint16_t len = 0; len <= 100; len++) {
+        std::vector<uint8_t> in(len);
+        for (auto &b : in) {
+            b = (uint8_t) rng();
+        }
+        const std::string expected = sprintfHex(in);
+
+        // nothing is written past the terminator
+        std::vector<char> out(2 * len + 8, 'x');
+        ASSERT_THAT(encode(out.data(), 2 * len + 1, in.data(), len), testing::Eq(UTILS_NOERROR));
+        ASSERT_THAT(std::string(out.data()), testing::Eq(expected)) << len;
+        ASSERT_THAT(std::string(out.begin() + 2 * len + 1, out.end()), testing::Eq(std::string(7, 'x')));
+
+        std::vector<char> inPlace(2 * len + 1, 'x');
+        memcpy(inPlace.data(), in.data(), len);
+        ASSERT_THAT(encode(inPlace.data(), inPlace.size(), (const uint8_t *) inPlace.data(), len),
+                    testing::Eq(UTILS_NOERROR));
+        ASSERT_THAT(std::string(inPlace.data()), testing::Eq(expected)) << "in place " << len;
+
+        // one char short, nothing is written
+        std::vector<char> small(2 * len, 'x');
+        ASSERT_THAT(encode(small.data(), small.size(), in.data(), len), testing::Eq(UTILS_NOT_ENOUGH_DATA));
+        ASSERT_THAT(std::string(small.begin(), small.end()), testing::Eq(std::string(2 * len, 'x')));
+    }
+
+    // every byte value
+    std::vector<uint8_t> all(256);
+    for (size_t i = 0; i < all.size(); i++) {
+        all[i] = (uint8_t) i;
+    }
+    char out[2 * 256 + 1];
+    ASSERT_THAT(encode(out, sizeof(out), all.data(), all.size()), testing::Eq(UTILS_NOERROR));
+    ASSERT_THAT(std::string(out), testing::Eq(sprintfHex(all)));
+}
+
+}
+
+// the SSE2 or NEON encoder when the host has one
+TEST(UTILS, HexEncode) {
+    expectHexEncode(hexEncode);
+}
+
+// the table encoder of the device
+TEST(UTILS, HexEncodeTable) {
+    expectHexEncode(portable_hexEncode);
+}
+
+TEST(UTILS, HexEncodeErrorIsNegative) {
+    char out[2];
+    const uint8_t in[1] = {0xAB};
+    ASSERT_THAT(hexEncode(out, sizeof(out), in, sizeof(in)), testing::Lt(0));
+}
@@ -0,0 +1,31 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+
+// utils.c with the table hex encoder and every global renamed, see utils_portable.h
+
+#define HEX_PORTABLE
+
+#define hexEncode portable_hexEncode
+#define printTime portable_printTime
+#define printTimeFormat portable_printTimeFormat
+#define crc8 portable_crc8
+#define crc8_update portable_crc8_update
+#define crc8_init portable_crc8_init
+#define crc8_xor_out portable_crc8_xor_out
+#define crc8_check portable_crc8_check
+#define crc8_poly7 portable_crc8_poly7
+
+#include "utils/utils.c"
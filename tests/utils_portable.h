@@ -0,0 +1,31 @@
+/*******************************************************************************
+*   (c) 2019 ZondaX GmbH
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+********************************************************************************/
+#pragma once
+
+// The table hex encoder of utils.c, as on the device, built next to the SIMD one of the host build.
+// Every global has a portable_ prefix
+
+#include "utils/utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int8_t portable_hexEncode(char *out, uint16_t outLen, const uint8_t *in, uint16_t inLen);
+
+#ifdef __cplusplus
+}
+#endif